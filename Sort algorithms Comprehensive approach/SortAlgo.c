@@ -32,7 +32,7 @@ int main() {
         return 1;
     }
 
-    fprintf(fp, "Size BubbleSort InsertionSort SelectionSort QuickSort\n");
+    fprintf(fp, "# Size BubbleSort InsertionSort SelectionSort QuickSort\n");
 
     for (int size = STEP_SIZE; size <= MAX_SIZE; size += STEP_SIZE) {
         generate_random_array(original_array, size);
@@ -157,22 +157,26 @@ double measure_time(void (*sort_func)(int[], int), int arr[], int n) {
     return cpu_time_used;
 }
 
+// Writes a gnuplot script that renders the chart to a file, so the run never waits on a plot window
 void plot_results() {
-    FILE *gnuplot = popen("gnuplot -persistent", "w");
+    FILE *gnuplot = fopen("sorting_times.gp", "w");
     if (gnuplot == NULL) {
-        printf("Error opening gnuplot.\n");
+        printf("Error opening sorting_times.gp.\n");
         return;
     }
 
+    fprintf(gnuplot, "set terminal svg size 1200,800\n");
+    fprintf(gnuplot, "set output 'sorting_times.svg'\n");
     fprintf(gnuplot, "set title 'Sorting Algorithm Comparison'\n");
     fprintf(gnuplot, "set xlabel 'Array Size'\n");
     fprintf(gnuplot, "set ylabel 'Time (seconds)'\n");
     fprintf(gnuplot, "set key outside\n");
     fprintf(gnuplot, "set grid\n");
-    fprintf(gnuplot, "plot 'sorting_times.dat' using 1:2 with lines title 'Bubble Sort', \
-                           '' using 1:3 with lines title 'Insertion Sort', \
-                           '' using 1:4 with lines title 'Selection Sort', \
-                           '' using 1:5 with lines title 'Quick Sort'\n");
+    fprintf(gnuplot, "plot 'sorting_times.dat' using 1:2 with lines title 'Bubble Sort', \\\n"
+                     "     '' using 1:3 with lines title 'Insertion Sort', \\\n"
+                     "     '' using 1:4 with lines title 'Selection Sort', \\\n"
+                     "     '' using 1:5 with lines title 'Quick Sort'\n");
 
     fclose(gnuplot);
-}
\ No newline at end of file
+    printf("Plot script written to sorting_times.gp; render with: gnuplot sorting_times.gp\n");
+}
@@ -1,7 +1,39 @@
+// _GNU_SOURCE for sched_setaffinity, which pins benchmark threads to a core
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <time.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Operation Counting
+// Build with -DSORT_COUNT_OPS to count element comparisons and swaps in the classic sorts
+// (a shift in insertion or shell sort counts as one swap; merges only compare). Without it
+// the hooks expand to nothing and cost nothing.
+#ifdef SORT_COUNT_OPS
+uint64_t sortComparisons, sortSwaps;
+#define COUNT_COMPARE() (sortComparisons++)
+#define COUNT_SWAP() (sortSwaps++)
+#else
+#define COUNT_COMPARE() ((void)0)
+#define COUNT_SWAP() ((void)0)
+#endif
 
 // Bubble Sort
 void bubbleSort(int arr[], int n)
@@ -10,8 +42,10 @@ void bubbleSort(int arr[], int n)
     {
         for (int j = 0; j < n - i - 1; j++)
         {
+            COUNT_COMPARE();
             if (arr[j] > arr[j + 1])
             {
+                COUNT_SWAP();
                 int temp = arr[j];
                 arr[j] = arr[j + 1];
                 arr[j + 1] = temp;
@@ -28,9 +62,11 @@ void selectionSort(int arr[], int n)
         int minIdx = i;
         for (int j = i + 1; j < n; j++)
         {
+            COUNT_COMPARE();
             if (arr[j] < arr[minIdx])
                 minIdx = j;
         }
+        COUNT_SWAP();
         int temp = arr[minIdx];
         arr[minIdx] = arr[i];
         arr[i] = temp;
@@ -44,8 +80,9 @@ void insertionSort(int arr[], int n)
     {
         int key = arr[i];
         int j = i - 1;
-        while (j >= 0 && arr[j] > key)
+        while (j >= 0 && (COUNT_COMPARE(), arr[j] > key))
         {
+            COUNT_SWAP();
             arr[j + 1] = arr[j];
             j--;
         }
@@ -68,6 +105,7 @@ void merge(int arr[], int l, int m, int r)
     int i = 0, j = 0, k = l;
     while (i < n1 && j < n2)
     {
+        COUNT_COMPARE();
         if (L[i] <= R[j])
         {
             arr[k] = L[i];
@@ -114,14 +152,17 @@ int partition(int arr[], int low, int high)
     int i = (low - 1);
     for (int j = low; j <= high - 1; j++)
     {
+        COUNT_COMPARE();
         if (arr[j] < pivot)
         {
+            COUNT_SWAP();
             i++;
             int temp = arr[i];
             arr[i] = arr[j];
             arr[j] = temp;
         }
     }
+    COUNT_SWAP();
     int temp = arr[i + 1];
     arr[i + 1] = arr[high];
     arr[high] = temp;
@@ -145,14 +186,15 @@ void heapify(int arr[], int n, int i)
     int left = 2 * i + 1;
     int right = 2 * i + 2;
 
-    if (left < n && arr[left] > arr[largest])
+    if (left < n && (COUNT_COMPARE(), arr[left] > arr[largest]))
         largest = left;
 
-    if (right < n && arr[right] > arr[largest])
+    if (right < n && (COUNT_COMPARE(), arr[right] > arr[largest]))
         largest = right;
 
     if (largest != i)
     {
+        COUNT_SWAP();
         int temp = arr[i];
         arr[i] = arr[largest];
         arr[largest] = temp;
@@ -167,6 +209,7 @@ void heapSort(int arr[], int n)
 
     for (int i = n - 1; i > 0; i--)
     {
+        COUNT_SWAP();
         int temp = arr[0];
         arr[0] = arr[i];
         arr[i] = temp;
@@ -205,252 +248,9976 @@ void countingSort(int arr[], int n, int exp)
         arr[i] = output[i];
 }
 
-void radixSort(int arr[], int n)
+// Base-10 Radix Sort (non-negative keys only)
+void radixSortBase10(int arr[], int n)
 {
     int max = getMax(arr, n);
     for (int exp = 1; max / exp > 0; exp *= 10)
         countingSort(arr, n, exp);
 }
 
-// Shell Sort
-void shellSort(int arr[], int n)
+// LSD Radix Sort (8/11/16-bit digits)
+// Keys are sorted as unsigned values; flip = sign bit maps signed order onto unsigned order.
+void radixSortLSD32(uint32_t keys[], int n, int digitBits, uint32_t flip)
 {
-    for (int gap = n / 2; gap > 0; gap /= 2)
+    if (n < 2)
+        return;
+
+    int passes = (32 + digitBits - 1) / digitBits;
+    size_t buckets = (size_t)1 << digitBits;
+    uint32_t mask = (uint32_t)(buckets - 1);
+    size_t *count = (size_t *)calloc(passes * buckets, sizeof(size_t));
+    uint32_t *buffer = (uint32_t *)malloc(n * sizeof(uint32_t));
+
+    // All digit histograms in one pass over the keys
+    for (int i = 0; i < n; i++)
     {
-        for (int i = gap; i < n; i++)
+        uint32_t k = keys[i] ^ flip;
+        for (int p = 0; p < passes; p++)
+            count[p * buckets + ((k >> (p * digitBits)) & mask)]++;
+    }
+
+    uint32_t *src = keys, *dst = buffer;
+    for (int p = 0; p < passes; p++)
+    {
+        size_t *c = count + p * buckets;
+        int shift = p * digitBits;
+
+        // Every key has the same digit: the pass would not move anything
+        if (c[((src[0] ^ flip) >> shift) & mask] == (size_t)n)
+            continue;
+
+        size_t sum = 0;
+        for (size_t b = 0; b < buckets; b++)
         {
-            int temp = arr[i];
-            int j;
-            for (j = i; j >= gap && arr[j - gap] > temp; j -= gap)
-                arr[j] = arr[j - gap];
-            arr[j] = temp;
+            size_t t = c[b];
+            c[b] = sum;
+            sum += t;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            uint32_t k = src[i];
+            dst[c[((k ^ flip) >> shift) & mask]++] = k;
         }
+
+        uint32_t *t = src;
+        src = dst;
+        dst = t;
     }
+
+    if (src != keys)
+        memcpy(keys, src, n * sizeof(uint32_t));
+
+    free(buffer);
+    free(count);
 }
 
-// Helper function to copy arrays
-void copyArray(int src[], int dest[], int n)
+void radixSortLSD64(uint64_t keys[], int n, int digitBits, uint64_t flip)
 {
+    if (n < 2)
+        return;
+
+    int passes = (64 + digitBits - 1) / digitBits;
+    size_t buckets = (size_t)1 << digitBits;
+    uint64_t mask = (uint64_t)(buckets - 1);
+    size_t *count = (size_t *)calloc(passes * buckets, sizeof(size_t));
+    uint64_t *buffer = (uint64_t *)malloc(n * sizeof(uint64_t));
+
     for (int i = 0; i < n; i++)
-        dest[i] = src[i];
+    {
+        uint64_t k = keys[i] ^ flip;
+        for (int p = 0; p < passes; p++)
+            count[p * buckets + ((k >> (p * digitBits)) & mask)]++;
+    }
+
+    uint64_t *src = keys, *dst = buffer;
+    for (int p = 0; p < passes; p++)
+    {
+        size_t *c = count + p * buckets;
+        int shift = p * digitBits;
+
+        if (c[((src[0] ^ flip) >> shift) & mask] == (size_t)n)
+            continue;
+
+        size_t sum = 0;
+        for (size_t b = 0; b < buckets; b++)
+        {
+            size_t t = c[b];
+            c[b] = sum;
+            sum += t;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            uint64_t k = src[i];
+            dst[c[((k ^ flip) >> shift) & mask]++] = k;
+        }
+
+        uint64_t *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    if (src != keys)
+        memcpy(keys, src, n * sizeof(uint64_t));
+
+    free(buffer);
+    free(count);
+}
+
+void radixSortBits(int arr[], int n, int digitBits)
+{
+    radixSortLSD32((uint32_t *)arr, n, digitBits, 0x80000000u);
+}
+
+// 8-bit digits keep the histograms in L1 for small inputs; 11-bit digits save a pass on large ones
+void radixSort(int arr[], int n)
+{
+    radixSortBits(arr, n, n < 65536 ? 8 : 11);
+}
+
+void radixSortU64(uint64_t arr[], int n)
+{
+    radixSortLSD64(arr, n, n < 65536 ? 8 : 11, 0);
 }
 
-void executeGnuplotComparison() {
-    FILE *gnuplot = popen("gnuplot -persist", "w");
-    if (gnuplot == NULL) {
-        printf("Failed to execute gnuplot.\n");
+// Sorts keys and moves values[i] along with keys[i]
+void radixSortPairs(int keys[], int values[], int n)
+{
+    if (n < 2)
         return;
+
+    const int passes = 4;
+    const uint32_t flip = 0x80000000u;
+    size_t count[4][256] = {{0}};
+    uint32_t *keyBuffer = (uint32_t *)malloc(n * sizeof(uint32_t));
+    int *valueBuffer = (int *)malloc(n * sizeof(int));
+
+    for (int i = 0; i < n; i++)
+    {
+        uint32_t k = (uint32_t)keys[i] ^ flip;
+        for (int p = 0; p < passes; p++)
+            count[p][(k >> (p * 8)) & 0xFF]++;
+    }
+
+    uint32_t *srcKeys = (uint32_t *)keys, *dstKeys = keyBuffer;
+    int *srcValues = values, *dstValues = valueBuffer;
+    for (int p = 0; p < passes; p++)
+    {
+        int shift = p * 8;
+        if (count[p][((srcKeys[0] ^ flip) >> shift) & 0xFF] == (size_t)n)
+            continue;
+
+        size_t sum = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            size_t t = count[p][b];
+            count[p][b] = sum;
+            sum += t;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            size_t pos = count[p][((srcKeys[i] ^ flip) >> shift) & 0xFF]++;
+            dstKeys[pos] = srcKeys[i];
+            dstValues[pos] = srcValues[i];
+        }
+
+        uint32_t *tk = srcKeys;
+        srcKeys = dstKeys;
+        dstKeys = tk;
+        int *tv = srcValues;
+        srcValues = dstValues;
+        dstValues = tv;
+    }
+
+    if (srcKeys != (uint32_t *)keys)
+    {
+        memcpy(keys, srcKeys, n * sizeof(int));
+        memcpy(values, srcValues, n * sizeof(int));
+    }
+
+    free(keyBuffer);
+    free(valueBuffer);
+}
+
+// Parallel Radix Sort
+// Each thread histograms its own chunk, offsets are prefix sums over (bucket, thread),
+// and keys are scattered through per-thread write-combining buffers of one cache line per bucket.
+#define WC_BYTES 64
+#define PARALLEL_RADIX_MIN 65536
+
+int hardwareThreads(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+typedef struct
+{
+    uint32_t *keys, *buffer;
+    int n, threads;
+    size_t (*hist)[256];
+    pthread_barrier_t barrier;
+} ParallelRadixShared;
+
+typedef struct
+{
+    ParallelRadixShared *shared;
+    int id;
+} RadixWorker;
+
+void *parallelRadixWorker(void *arg)
+{
+    RadixWorker *w = (RadixWorker *)arg;
+    ParallelRadixShared *sh = w->shared;
+    const uint32_t flip = 0x80000000u;
+    enum { LINE = WC_BYTES / sizeof(uint32_t) };
+    int t = w->id;
+    int begin = (int)((long long)sh->n * t / sh->threads);
+    int end = (int)((long long)sh->n * (t + 1) / sh->threads);
+    uint32_t *src = sh->keys, *dst = sh->buffer;
+    uint32_t(*wc)[LINE] = (uint32_t(*)[LINE])aligned_alloc(WC_BYTES, 256 * WC_BYTES);
+    size_t pos[256];
+    int fill[256];
+
+    for (int p = 0; p < 4; p++)
+    {
+        int shift = p * 8;
+        size_t *h = sh->hist[t];
+        memset(h, 0, 256 * sizeof(size_t));
+        for (int i = begin; i < end; i++)
+            h[((src[i] ^ flip) >> shift) & 0xFF]++;
+        pthread_barrier_wait(&sh->barrier);
+
+        size_t sum = 0;
+        int constant = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            size_t total = 0;
+            for (int u = 0; u < sh->threads; u++)
+            {
+                if (u == t)
+                    pos[b] = sum + total;
+                total += sh->hist[u][b];
+            }
+            if (total == (size_t)sh->n)
+                constant = 1;
+            sum += total;
+        }
+
+        if (!constant)
+        {
+            memset(fill, 0, sizeof(fill));
+            for (int i = begin; i < end; i++)
+            {
+                uint32_t k = src[i];
+                int d = ((k ^ flip) >> shift) & 0xFF;
+                wc[d][fill[d]++] = k;
+                if (fill[d] == LINE)
+                {
+                    memcpy(dst + pos[d], wc[d], WC_BYTES);
+                    pos[d] += LINE;
+                    fill[d] = 0;
+                }
+            }
+            for (int b = 0; b < 256; b++)
+                memcpy(dst + pos[b], wc[b], fill[b] * sizeof(uint32_t));
+
+            uint32_t *temp = src;
+            src = dst;
+            dst = temp;
+        }
+        // Nobody may clear a histogram or overwrite src before every thread is done with it
+        pthread_barrier_wait(&sh->barrier);
     }
-    fprintf(gnuplot, "set title 'Sorting Algorithm Performance'\n");
-    fprintf(gnuplot, "set xlabel 'Array Size'\n");
-    fprintf(gnuplot, "set ylabel 'Time (seconds)'\n");
-    fprintf(gnuplot, "set key outside\n");
-    fprintf(gnuplot, "set logscale y 10\n");
-    fprintf(gnuplot, "plot \
-        'all_sorting_times.dat' using 1:2 with lines linewidth 4 linecolor rgb 'red' title 'Bubble Sort', \
-        'all_sorting_times.dat' using 1:3 with lines linewidth 4 linecolor rgb 'blue' title 'Selection Sort', \
-        'all_sorting_times.dat' using 1:4 with lines linewidth 4 linecolor rgb 'green' title 'Insertion Sort', \
-        'all_sorting_times.dat' using 1:5 with lines linewidth 4 linecolor rgb 'orange' title 'Merge Sort', \
-        'all_sorting_times.dat' using 1:6 with lines linewidth 4 linecolor rgb 'purple' title 'Quick Sort', \
-        'all_sorting_times.dat' using 1:7 with lines linewidth 4 linecolor rgb 'brown' title 'Heap Sort', \
-        'all_sorting_times.dat' using 1:8 with lines linewidth 4 linecolor rgb 'cyan' title 'Radix Sort', \
-        'all_sorting_times.dat' using 1:9 with lines linewidth 4 linecolor rgb 'magenta' title 'Shell Sort'\n");
-    pclose(gnuplot);
-    printf("Gnuplot executed. Close the plot window to return to the menu.\n");
+
+    if (src != sh->keys)
+        memcpy(sh->keys + begin, src + begin, (end - begin) * sizeof(uint32_t));
+
+    free(wc);
+    return NULL;
 }
 
-void executeGnuplotSingleAlgorithm(const char *algorithm, int column) {
-    FILE *gnuplot = popen("gnuplot -persist", "w");
-    if (gnuplot == NULL) {
-        printf("Failed to execute gnuplot.\n");
+void parallelRadixSort(int arr[], int n, int threads)
+{
+    if (threads <= 1 || n < PARALLEL_RADIX_MIN)
+    {
+        radixSortBits(arr, n, 8);
         return;
     }
-    fprintf(gnuplot, "set title 'Performance of %s'\n", algorithm);
-    fprintf(gnuplot, "set xlabel 'Array Size'\n");
-    fprintf(gnuplot, "set ylabel 'Time (seconds)'\n");
-    fprintf(gnuplot, "set logscale y 10\n");
-    fprintf(gnuplot, "plot 'all_sorting_times.dat' using 1:%d with lines linewidth 4 title '%s'\n", column, algorithm);
-    pclose(gnuplot);
-    printf("Gnuplot executed. Close the plot window to return to the menu.\n");
+
+    ParallelRadixShared shared;
+    shared.keys = (uint32_t *)arr;
+    shared.buffer = (uint32_t *)malloc(n * sizeof(uint32_t));
+    shared.n = n;
+    shared.threads = threads;
+    shared.hist = (size_t(*)[256])calloc(threads, sizeof(*shared.hist));
+    pthread_barrier_init(&shared.barrier, NULL, threads);
+
+    pthread_t *ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    RadixWorker *workers = (RadixWorker *)malloc(threads * sizeof(RadixWorker));
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t].shared = &shared;
+        workers[t].id = t;
+        pthread_create(&ids[t], NULL, parallelRadixWorker, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++)
+        pthread_join(ids[t], NULL);
+
+    pthread_barrier_destroy(&shared.barrier);
+    free(workers);
+    free(ids);
+    free(shared.hist);
+    free(shared.buffer);
 }
 
+// Parallel MSD Radix Sort (uint64)
+// One parallel scatter on the most significant byte that differs between keys,
+// then threads take buckets off a shared counter and finish them with LSD passes.
+typedef struct
+{
+    uint64_t *keys, *buffer;
+    int n, threads, shift;
+    size_t (*hist)[256];
+    size_t bucketStart[257];
+    int nextBucket;
+    uint64_t diffBits;
+    pthread_mutex_t lock;
+    pthread_barrier_t barrier;
+} ParallelMSDShared;
 
-int main()
+typedef struct
 {
-    int sizes[] = {1000, 2000, 4000, 8000, 16000, 32000, 64000};
-    int numSizes = sizeof(sizes) / sizeof(sizes[0]);
-    int maxSize = 64000;
+    ParallelMSDShared *shared;
+    int id;
+} MSDWorker;
 
-    FILE *fp = fopen("all_sorting_times.dat", "w");
+void *parallelMSDWorker(void *arg)
+{
+    MSDWorker *w = (MSDWorker *)arg;
+    ParallelMSDShared *sh = w->shared;
+    enum { LINE = WC_BYTES / sizeof(uint64_t) };
+    int t = w->id;
+    int begin = (int)((long long)sh->n * t / sh->threads);
+    int end = (int)((long long)sh->n * (t + 1) / sh->threads);
 
-    int *arr = (int *)malloc(maxSize * sizeof(int));
-    int *temp = (int *)malloc(maxSize * sizeof(int));
+    // Bits that differ from the first key decide which byte splits the input
+    uint64_t first = sh->keys[0], diff = 0;
+    for (int i = begin; i < end; i++)
+        diff |= sh->keys[i] ^ first;
+    pthread_mutex_lock(&sh->lock);
+    sh->diffBits |= diff;
+    pthread_mutex_unlock(&sh->lock);
+    pthread_barrier_wait(&sh->barrier);
 
-    srand(time(NULL));
+    if (sh->diffBits == 0)
+        return NULL;
+    int shift = 0;
+    while (shift + 8 < 64 && (sh->diffBits >> (shift + 8)) != 0)
+        shift += 8;
 
-    for (int i = 0; i < maxSize; i++)
-        arr[i] = rand() % 1000;
+    size_t *h = sh->hist[t];
+    memset(h, 0, 256 * sizeof(size_t));
+    for (int i = begin; i < end; i++)
+        h[(sh->keys[i] >> shift) & 0xFF]++;
+    pthread_barrier_wait(&sh->barrier);
 
-    for (int i = 0; i < numSizes; i++)
+    size_t pos[256], sum = 0;
+    for (int b = 0; b < 256; b++)
     {
-        int n = sizes[i];
+        if (t == 0)
+            sh->bucketStart[b] = sum;
+        for (int u = 0; u < sh->threads; u++)
+        {
+            if (u == t)
+                pos[b] = sum;
+            sum += sh->hist[u][b];
+        }
+    }
+    if (t == 0)
+        sh->bucketStart[256] = sum;
 
-        copyArray(arr, temp, n);
-        clock_t start = clock();
-        bubbleSort(temp, n);
-        clock_t end = clock();
-        double bubbleTime = (double)(end - start) / CLOCKS_PER_SEC;
-
-        copyArray(arr, temp, n);
-        start = clock();
-        selectionSort(temp, n);
-        end = clock();
-        double selectionTime = (double)(end - start) / CLOCKS_PER_SEC;
-
-        copyArray(arr, temp, n);
-        start = clock();
-        insertionSort(temp, n);
-        end = clock();
-        double insertionTime = (double)(end - start) / CLOCKS_PER_SEC;
-
-        copyArray(arr, temp, n);
-        start = clock();
-        mergeSort(temp, 0, n - 1);
-        end = clock();
-        double mergeTime = (double)(end - start) / CLOCKS_PER_SEC;
-
-        copyArray(arr, temp, n);
-        start = clock();
-        quickSort(temp, 0, n - 1);
-        end = clock();
-        double quickTime = (double)(end - start) / CLOCKS_PER_SEC;
-
-        copyArray(arr, temp, n);
-        start = clock();
-        heapSort(temp, n);
-        end = clock();
-        double heapTime = (double)(end - start) / CLOCKS_PER_SEC;
-
-        copyArray(arr, temp, n);
-        start = clock();
-        radixSort(temp, n);
-        end = clock();
-        double radixTime = (double)(end - start) / CLOCKS_PER_SEC;
-
-        copyArray(arr, temp, n);
-        start = clock();
-        shellSort(temp, n);
-        end = clock();
-        double shellTime = (double)(end - start) / CLOCKS_PER_SEC;
-
-        fprintf(fp, "%d %f %f %f %f %f %f %f %f\n", n, bubbleTime, selectionTime, insertionTime, mergeTime, quickTime, heapTime, radixTime, shellTime);
+    uint64_t(*wc)[LINE] = (uint64_t(*)[LINE])aligned_alloc(WC_BYTES, 256 * WC_BYTES);
+    int fill[256] = {0};
+    for (int i = begin; i < end; i++)
+    {
+        uint64_t k = sh->keys[i];
+        int d = (k >> shift) & 0xFF;
+        wc[d][fill[d]++] = k;
+        if (fill[d] == LINE)
+        {
+            memcpy(sh->buffer + pos[d], wc[d], WC_BYTES);
+            pos[d] += LINE;
+            fill[d] = 0;
+        }
     }
+    for (int b = 0; b < 256; b++)
+        memcpy(sh->buffer + pos[b], wc[b], fill[b] * sizeof(uint64_t));
+    free(wc);
+    pthread_barrier_wait(&sh->barrier);
 
-    fclose(fp);
-    free(arr);
-    free(temp);
+    for (;;)
+    {
+        pthread_mutex_lock(&sh->lock);
+        int b = sh->nextBucket++;
+        pthread_mutex_unlock(&sh->lock);
+        if (b >= 256)
+            break;
 
-    int choice;
-    do
+        size_t start = sh->bucketStart[b], count = sh->bucketStart[b + 1] - start;
+        memcpy(sh->keys + start, sh->buffer + start, count * sizeof(uint64_t));
+        radixSortLSD64(sh->keys + start, (int)count, 8, 0);
+    }
+    return NULL;
+}
+
+void parallelRadixSortU64(uint64_t arr[], int n, int threads)
+{
+    if (threads <= 1 || n < PARALLEL_RADIX_MIN)
     {
-        printf("\nSorting Algorithm Menu:\n");
-        printf("1. Bubble Sort\n");
-        printf("2. Selection Sort\n");
-        printf("3. Insertion Sort\n");
-        printf("4. Merge Sort\n");
-        printf("5. Quick Sort\n");
-        printf("6. Heap Sort\n");
-        printf("7. Radix Sort\n");
-        printf("8. Shell Sort\n");
-        printf("9. Execute Gnuplot for All Algorithms\n");
-        printf("10. Plot Single Algorithm Performance\n");
-        printf("11. Exit\n");
-        printf("Enter your choice: ");
-        scanf("%d", &choice);
+        radixSortU64(arr, n);
+        return;
+    }
 
-        if (choice >= 1 && choice <= 8)
-        {
-            printf("Enter array size: ");
-            int n;
-            scanf("%d", &n);
-            int *testArr = (int *)malloc(n * sizeof(int));
-            for (int i = 0; i < n; i++)
-                testArr[i] = rand() % 1000;
+    ParallelMSDShared shared;
+    shared.keys = arr;
+    shared.buffer = (uint64_t *)malloc(n * sizeof(uint64_t));
+    shared.n = n;
+    shared.threads = threads;
+    shared.hist = (size_t(*)[256])calloc(threads, sizeof(*shared.hist));
+    shared.nextBucket = 0;
+    shared.diffBits = 0;
+    pthread_mutex_init(&shared.lock, NULL);
+    pthread_barrier_init(&shared.barrier, NULL, threads);
 
-            clock_t start, end;
-            double timeTaken;
+    pthread_t *ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    MSDWorker *workers = (MSDWorker *)malloc(threads * sizeof(MSDWorker));
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t].shared = &shared;
+        workers[t].id = t;
+        pthread_create(&ids[t], NULL, parallelMSDWorker, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++)
+        pthread_join(ids[t], NULL);
 
-            switch (choice)
+    pthread_barrier_destroy(&shared.barrier);
+    pthread_mutex_destroy(&shared.lock);
+    free(workers);
+    free(ids);
+    free(shared.hist);
+    free(shared.buffer);
+}
+
+// Shell Sort
+// Gap sequences: Shell's n/2 halving (O(n^2) worst case), Knuth (3^k - 1) / 2, Sedgewick 1986
+// 4^k + 3 * 2^(k-1) + 1, Tokuda ceil(2.25 h + 1), Ciura's measured gaps extended by 2.25,
+// and Pratt's 3-smooth numbers 2^p 3^q (O(n log^2 n), many passes).
+enum
+{
+    GAP_SHELL,
+    GAP_KNUTH,
+    GAP_SEDGEWICK86,
+    GAP_TOKUDA,
+    GAP_CIURA,
+    GAP_PRATT,
+    GAP_SEQUENCES
+};
+
+const char *gapSequenceNames[] = {"shell", "knuth", "sedgewick86", "tokuda", "ciura", "pratt"};
+
+// Picked from --bench-shell sweeps
+#define SHELL_DEFAULT_GAPS GAP_SEDGEWICK86
+#define SHELL_MAX_GAPS 1024
+
+// Fills gaps[] in decreasing order, every gap < n, ending with 1; returns the count
+int shellGapSequence(int sequence, int n, int gaps[])
+{
+    long long ascending[SHELL_MAX_GAPS];
+    int count = 0;
+
+    switch (sequence)
+    {
+    case GAP_SHELL:
+        for (int gap = n / 2; gap > 0; gap /= 2)
+            gaps[count++] = gap;
+        return count;
+    case GAP_KNUTH:
+        for (long long h = 1; h == 1 || h < n / 3; h = 3 * h + 1)
+            ascending[count++] = h;
+        break;
+    case GAP_SEDGEWICK86:
+        ascending[count++] = 1;
+        for (int k = 1; (1ll << (2 * k)) + 3 * (1ll << (k - 1)) + 1 < n; k++)
+            ascending[count++] = (1ll << (2 * k)) + 3 * (1ll << (k - 1)) + 1;
+        break;
+    case GAP_TOKUDA:
+        for (double h = 1.0; h == 1.0 || ceil(h) < n; h = 2.25 * h + 1.0)
+            ascending[count++] = (long long)ceil(h);
+        break;
+    case GAP_CIURA:
+    {
+        static const int ciura[] = {1, 4, 10, 23, 57, 132, 301, 701, 1750};
+        long long h = 1;
+        for (int i = 0; i < 9 && (i == 0 || ciura[i] < n); i++)
+            ascending[count++] = h = ciura[i];
+        while (count >= 9 && (long long)(2.25 * h) < n)
+            ascending[count++] = h = (long long)(2.25 * h);
+        break;
+    }
+    default:
+        for (long long p2 = 1; p2 == 1 || p2 < n; p2 *= 2)
+            for (long long h = p2; h == 1 || h < n; h *= 3)
+                ascending[count++] = h;
+        break;
+    }
+
+    for (int i = 0; i < count; i++)
+        gaps[i] = (int)ascending[count - 1 - i];
+    if (sequence == GAP_PRATT)
+    {
+        // The 3-smooth numbers were generated grouped by power of two
+        for (int i = 1; i < count; i++)
+        {
+            int key = gaps[i], j = i - 1;
+            while (j >= 0 && gaps[j] < key)
             {
-            case 1:
-                start = clock();
-                bubbleSort(testArr, n);
-                end = clock();
-                printf("Bubble Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
-                break;
-            case 2:
-                start = clock();
-                selectionSort(testArr, n);
-                end = clock();
-                printf("Selection Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
-                break;
-            case 3:
-                start = clock();
-                insertionSort(testArr, n);
-                end = clock();
-                printf("Insertion Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
-                break;
-            case 4:
-                start = clock();
-                mergeSort(testArr, 0, n - 1);
-                end = clock();
-                    printf("Merge Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
-                    break;
-                case 5:
-                    start = clock();
-                    quickSort(testArr, 0, n - 1);
-                    end = clock();
-                    printf("Quick Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
-                    break;
-                case 6:
-                    start = clock();
-                    heapSort(testArr, n);
-                    end = clock();
-                    printf("Heap Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
-                    break;
-                case 7:
-                    start = clock();
-                    radixSort(testArr, n);
-                    end = clock();
-                    printf("Radix Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
-                    break;
-                case 8:
-                    start = clock();
-                    shellSort(testArr, n);
-                    end = clock();
-                    printf("Shell Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
-                    break;
+                gaps[j + 1] = gaps[j];
+                j--;
             }
-            free(testArr);
+            gaps[j + 1] = key;
         }
-        else if (choice == 9)
+    }
+    return count;
+}
+
+// One gap-h pass. i walks the array in order, so all h chains advance together and every
+// step reads two forward-moving streams (i and i - h) instead of striding through one chain.
+void shellPass(int arr[], int n, int gap)
+{
+    // Every chain has at most two elements: a branchless compare-exchange pass that vectorizes
+    if (2 * (long long)gap >= n)
+    {
+        for (int i = gap; i < n; i++)
         {
-            executeGnuplotComparison();
-            printf("Gnuplot executed for all algorithms.\n");
-            break;
+            int a = arr[i - gap], b = arr[i];
+            COUNT_COMPARE();
+            if (b < a)
+                COUNT_SWAP();
+            arr[i - gap] = a < b ? a : b;
+            arr[i] = a < b ? b : a;
         }
-        else if (choice == 10)
+        return;
+    }
+
+    for (int i = gap; i < n; i++)
+    {
+        int temp = arr[i];
+        int j;
+        for (j = i; j >= gap && (COUNT_COMPARE(), arr[j - gap] > temp); j -= gap)
+        {
+            COUNT_SWAP();
+            arr[j] = arr[j - gap];
+        }
+        arr[j] = temp;
+    }
+}
+
+void shellSortGaps(int arr[], int n, int sequence)
+{
+    int gaps[SHELL_MAX_GAPS];
+    int count = shellGapSequence(sequence, n, gaps);
+    for (int g = 0; g < count; g++)
+        shellPass(arr, n, gaps[g]);
+}
+
+void shellSort(int arr[], int n)
+{
+    shellSortGaps(arr, n, SHELL_DEFAULT_GAPS);
+}
+
+// Bottom-Up Heap Sort
+// Floyd's variant: the hole left at the root walks down to a leaf along the larger child (only
+// siblings are compared, never the sinking value), then the displaced value climbs back up,
+// which is rarely more than a level or two. Past L2 every level is a cache miss, so the
+// grandchildren of the current node are prefetched while its children are compared.
+// Arity is 2, 4 or 8; 4 and 8 keep each sibling group inside one cache line: the heap starts up to arity - 1
+// elements into the array so every group begins on a 4 * arity byte boundary, and the skipped
+// prefix is filled with the smallest elements beforehand.
+#define HEAP_DEFAULT_ARITY 4
+#define HEAP_WIDE_MIN (1 << 21) // past the last-level cache 8-ary halves the levels that miss
+#define HEAP_PREFETCH_MIN 16384
+
+// Index of the largest of a[first..first + d), found by a branchless pairwise tournament
+static inline __attribute__((always_inline)) int heapMaxChild(const int a[], int first, const int d)
+{
+    int idx[4];
+    for (int c = 0; c < d; c += 2)
+        idx[c / 2] = first + c + (a[first + c + 1] > a[first + c]);
+    for (int width = d / 2; width > 1; width /= 2)
+        for (int c = 0; c < width / 2; c++)
+        {
+            int l = idx[2 * c], r = idx[2 * c + 1];
+            idx[c] = l + (r - l) * (a[r] > a[l]);
+        }
+    return idx[0];
+}
+
+// Moves the hole at root of the arity-d max-heap a[0..n) down to a leaf, then places value.
+// Inlined per arity below so the tournament and index arithmetic use a constant d.
+static inline __attribute__((always_inline)) void heapSiftFloydArity(int a[], int n, const int d, int root, int value)
+{
+    int hole = root;
+    int lastFull = n - 1 - d >= 0 ? (n - 1 - d) / d : -1;
+    while (hole <= lastFull)
+    {
+        int child = d * hole + 1;
+        if (n > HEAP_PREFETCH_MIN)
+        {
+            long long grandchild = (long long)d * child + 1;
+            for (int p = 0; p < d * d && grandchild + p < n; p += 64 / sizeof(int))
+                __builtin_prefetch(&a[grandchild + p]);
+        }
+        int best = heapMaxChild(a, child, d);
+        a[hole] = a[best];
+        hole = best;
+    }
+
+    // At most one node has a partial group of children
+    if (n > 1 && hole <= (n - 2) / d)
+    {
+        int best = d * hole + 1;
+        for (int c = best + 1; c < n; c++)
+            best = a[c] > a[best] ? c : best;
+        a[hole] = a[best];
+        hole = best;
+    }
+
+    while (hole > root)
+    {
+        int parent = (hole - 1) / d;
+        if (a[parent] >= value)
+            break;
+        a[hole] = a[parent];
+        hole = parent;
+    }
+    a[hole] = value;
+}
+
+static inline void heapBuildArity(int a[], int n, const int d)
+{
+    for (int i = (n - 2) / d; i >= 0 && n > 1; i--)
+        heapSiftFloydArity(a, n, d, i, a[i]);
+}
+
+// Sorts a max-heap in place by repeatedly moving the maximum to the end
+static inline void heapDrainArity(int a[], int n, const int d)
+{
+    for (int end = n - 1; end > 0; end--)
+    {
+        int value = a[end];
+        a[end] = a[0];
+        heapSiftFloydArity(a, end, d, 0, value);
+    }
+}
+
+// Entry points dispatch once on the arity so the loops above are compiled per constant d
+#define HEAP_ARITY_SWITCH(d, call)                           \
+    switch (d)                                               \
+    {                                                        \
+    case 2:                                                  \
+        call(2);                                             \
+        break;                                               \
+    case 4:                                                  \
+        call(4);                                             \
+        break;                                               \
+    case 8:                                                  \
+        call(8);                                             \
+        break;                                               \
+    default:                                                 \
+        printf("Error: unsupported heap arity %d\n", d);    \
+        break;                                               \
+    }
+
+void heapSiftFloyd(int a[], int n, int d, int root, int value)
+{
+#define HEAP_SIFT(arity) heapSiftFloydArity(a, n, arity, root, value)
+    HEAP_ARITY_SWITCH(d, HEAP_SIFT)
+#undef HEAP_SIFT
+}
+
+void heapBuild(int a[], int n, int d)
+{
+#define HEAP_BUILD(arity) heapBuildArity(a, n, arity)
+    HEAP_ARITY_SWITCH(d, HEAP_BUILD)
+#undef HEAP_BUILD
+}
+
+void heapDrain(int a[], int n, int d)
+{
+#define HEAP_DRAIN(arity) heapDrainArity(a, n, arity)
+    HEAP_ARITY_SWITCH(d, HEAP_DRAIN)
+#undef HEAP_DRAIN
+}
+
+// Replaces the maximum of the heap with value
+void heapReplaceTop(int a[], int n, int d, int value)
+{
+    heapSiftFloyd(a, n, d, 0, value);
+}
+
+// Moves the k smallest elements into arr[0..k), in no particular order (max-heap order)
+void heapSelectSmallest(int arr[], int n, int k, int d)
+{
+    if (k <= 0 || k >= n)
+        return;
+    heapBuild(arr, k, d);
+    for (int i = k; i < n; i++)
+    {
+        if (arr[i] < arr[0])
+        {
+            int value = arr[i];
+            arr[i] = arr[0];
+            heapReplaceTop(arr, k, d, value);
+        }
+    }
+}
+
+// arr[0..k) becomes the k smallest elements in ascending order; the rest is left unordered
+void heapPartialSort(int arr[], int n, int k)
+{
+    if (k > n)
+        k = n;
+    if (k <= 0)
+        return;
+    if (k < n)
+        heapSelectSmallest(arr, n, k, HEAP_DEFAULT_ARITY);
+    else
+        heapBuild(arr, n, HEAP_DEFAULT_ARITY);
+    heapDrain(arr, k, HEAP_DEFAULT_ARITY);
+}
+
+void heapSortDary(int arr[], int n, int d)
+{
+    int skip = 0;
+    if (d > 2)
+        while (skip < n && (uintptr_t)(arr + skip + 1) % (d * sizeof(int)) != 0)
+            skip++;
+
+    // The skipped prefix must end up holding the smallest elements: keep the running
+    // `skip` smallest there with one scan, then insertion sort them
+    if (skip > 0 && skip < n)
+    {
+        int largest = 0;
+        for (int j = 1; j < skip; j++)
+            if (arr[j] > arr[largest])
+                largest = j;
+        for (int i = skip; i < n; i++)
+        {
+            if (arr[i] < arr[largest])
+            {
+                int temp = arr[i];
+                arr[i] = arr[largest];
+                arr[largest] = temp;
+                for (int j = 0; j < skip; j++)
+                    if (arr[j] > arr[largest])
+                        largest = j;
+            }
+        }
+    }
+    insertionSort(arr, skip);
+
+    heapBuild(arr + skip, n - skip, d);
+    heapDrain(arr + skip, n - skip, d);
+}
+
+void heapSortBottomUp(int arr[], int n)
+{
+    heapSortDary(arr, n, n > HEAP_WIDE_MIN ? 8 : HEAP_DEFAULT_ARITY);
+}
+
+// Intro Sort
+// Median-of-three Hoare partitioning, heap sort once the depth budget is spent,
+// and one insertion sort pass over the nearly sorted result.
+#define INTRO_THRESHOLD 16
+
+// Partitions of at most threshold elements are left to smallSort, or to the final pass when it is NULL
+void introSortLoop(int arr[], int low, int high, int depthLimit, int threshold, void (*smallSort)(int[], int))
+{
+    while (high - low >= threshold)
+    {
+        if (depthLimit == 0)
+        {
+            heapSort(arr + low, high - low + 1);
+            return;
+        }
+        depthLimit--;
+
+        int mid = low + (high - low) / 2, temp;
+        if (arr[mid] < arr[low])
+        {
+            temp = arr[mid];
+            arr[mid] = arr[low];
+            arr[low] = temp;
+        }
+        if (arr[high] < arr[low])
+        {
+            temp = arr[high];
+            arr[high] = arr[low];
+            arr[low] = temp;
+        }
+        if (arr[high] < arr[mid])
+        {
+            temp = arr[high];
+            arr[high] = arr[mid];
+            arr[mid] = temp;
+        }
+
+        // arr[low] <= pivot <= arr[high] act as sentinels for both scans
+        int pivot = arr[mid];
+        int i = low, j = high;
+        for (;;)
+        {
+            while (arr[++i] < pivot)
+                ;
+            while (pivot < arr[--j])
+                ;
+            if (i >= j)
+                break;
+            temp = arr[i];
+            arr[i] = arr[j];
+            arr[j] = temp;
+        }
+
+        // Recurse into the smaller side to bound the stack depth
+        if (j - low < high - j)
+        {
+            introSortLoop(arr, low, j, depthLimit, threshold, smallSort);
+            low = j + 1;
+        }
+        else
+        {
+            introSortLoop(arr, j + 1, high, depthLimit, threshold, smallSort);
+            high = j;
+        }
+    }
+
+    if (smallSort != NULL && low < high)
+        smallSort(arr + low, high - low + 1);
+}
+
+int introDepthLimit(int n)
+{
+    int depthLimit = 0;
+    for (int m = n; m > 1; m >>= 1)
+        depthLimit += 2;
+    return depthLimit;
+}
+
+void introSort(int arr[], int n)
+{
+    introSortLoop(arr, 0, n - 1, introDepthLimit(n), INTRO_THRESHOLD, NULL);
+    insertionSort(arr, n);
+}
+
+// Generic Sorts
+// DEFINE_SORTS(name, T, LESS) instantiates the comparison sorts for element type T with the
+// comparator LESS(a, b) expanded inline, so there is no qsort-style call per comparison:
+//   nameInsertionSort(T arr[], int n), nameHeapSort, nameIntroSort, nameMergeSort (stable)
+// DEFINE_RADIX_SORT(name, T, KEY_T, KEY) adds nameRadixSort, an 8-bit LSD sort that moves whole
+// elements by KEY(x), an unsigned KEY_T whose unsigned order is the sort order.
+#define DEFINE_SORTS(name, T, LESS)                                                  \
+    void name##InsertionSort(T arr[], int n)                                         \
+    {                                                                                \
+        for (int i = 1; i < n; i++)                                                  \
+        {                                                                            \
+            T key = arr[i];                                                          \
+            int j = i - 1;                                                           \
+            while (j >= 0 && LESS(key, arr[j]))                                      \
+            {                                                                        \
+                arr[j + 1] = arr[j];                                                 \
+                j--;                                                                 \
+            }                                                                        \
+            arr[j + 1] = key;                                                        \
+        }                                                                            \
+    }                                                                                \
+                                                                                     \
+    void name##SiftDown(T arr[], int n, int i)                                       \
+    {                                                                                \
+        T value = arr[i];                                                            \
+        for (;;)                                                                     \
+        {                                                                            \
+            int child = 2 * i + 1;                                                   \
+            if (child >= n)                                                          \
+                break;                                                               \
+            if (child + 1 < n && LESS(arr[child], arr[child + 1]))                   \
+                child++;                                                             \
+            if (!LESS(value, arr[child]))                                            \
+                break;                                                               \
+            arr[i] = arr[child];                                                     \
+            i = child;                                                               \
+        }                                                                            \
+        arr[i] = value;                                                              \
+    }                                                                                \
+                                                                                     \
+    void name##HeapSort(T arr[], int n)                                              \
+    {                                                                                \
+        for (int i = n / 2 - 1; i >= 0; i--)                                         \
+            name##SiftDown(arr, n, i);                                               \
+        for (int i = n - 1; i > 0; i--)                                              \
+        {                                                                            \
+            T temp = arr[0];                                                         \
+            arr[0] = arr[i];                                                         \
+            arr[i] = temp;                                                           \
+            name##SiftDown(arr, i, 0);                                               \
+        }                                                                            \
+    }                                                                                \
+                                                                                     \
+    void name##IntroSortLoop(T arr[], int low, int high, int depthLimit)             \
+    {                                                                                \
+        while (high - low > INTRO_THRESHOLD)                                         \
+        {                                                                            \
+            if (depthLimit-- == 0)                                                   \
+            {                                                                        \
+                name##HeapSort(arr + low, high - low + 1);                           \
+                return;                                                              \
+            }                                                                        \
+            int mid = low + (high - low) / 2;                                        \
+            T temp;                                                                  \
+            if (LESS(arr[mid], arr[low]))                                            \
+            {                                                                        \
+                temp = arr[mid];                                                     \
+                arr[mid] = arr[low];                                                 \
+                arr[low] = temp;                                                     \
+            }                                                                        \
+            if (LESS(arr[high], arr[low]))                                           \
+            {                                                                        \
+                temp = arr[high];                                                    \
+                arr[high] = arr[low];                                                \
+                arr[low] = temp;                                                     \
+            }                                                                        \
+            if (LESS(arr[high], arr[mid]))                                           \
+            {                                                                        \
+                temp = arr[high];                                                    \
+                arr[high] = arr[mid];                                                \
+                arr[mid] = temp;                                                     \
+            }                                                                        \
+            T pivot = arr[mid];                                                      \
+            int i = low, j = high;                                                   \
+            for (;;)                                                                 \
+            {                                                                        \
+                while (LESS(arr[++i], pivot))                                        \
+                    ;                                                                \
+                while (LESS(pivot, arr[--j]))                                        \
+                    ;                                                                \
+                if (i >= j)                                                          \
+                    break;                                                           \
+                temp = arr[i];                                                       \
+                arr[i] = arr[j];                                                     \
+                arr[j] = temp;                                                       \
+            }                                                                        \
+            if (j - low < high - j)                                                  \
+            {                                                                        \
+                name##IntroSortLoop(arr, low, j, depthLimit);                        \
+                low = j + 1;                                                         \
+            }                                                                        \
+            else                                                                     \
+            {                                                                        \
+                name##IntroSortLoop(arr, j + 1, high, depthLimit);                   \
+                high = j;                                                            \
+            }                                                                        \
+        }                                                                            \
+    }                                                                                \
+                                                                                     \
+    void name##IntroSort(T arr[], int n)                                             \
+    {                                                                                \
+        name##IntroSortLoop(arr, 0, n - 1, introDepthLimit(n));                      \
+        name##InsertionSort(arr, n);                                                 \
+    }                                                                                \
+                                                                                     \
+    void name##MergeSortRec(T arr[], T buffer[], int n)                              \
+    {                                                                                \
+        if (n <= INTRO_THRESHOLD)                                                    \
+        {                                                                            \
+            name##InsertionSort(arr, n);                                             \
+            return;                                                                  \
+        }                                                                            \
+        int half = n / 2;                                                            \
+        name##MergeSortRec(arr, buffer, half);                                       \
+        name##MergeSortRec(arr + half, buffer, n - half);                            \
+        if (!LESS(arr[half], arr[half - 1]))                                         \
+            return;                                                                  \
+        memcpy(buffer, arr, half * sizeof(T));                                       \
+        int i = 0, j = half, k = 0;                                                  \
+        while (i < half && j < n)                                                    \
+        {                                                                            \
+            if (LESS(arr[j], buffer[i]))                                             \
+                arr[k++] = arr[j++];                                                 \
+            else                                                                     \
+                arr[k++] = buffer[i++];                                              \
+        }                                                                            \
+        while (i < half)                                                             \
+            arr[k++] = buffer[i++];                                                  \
+    }                                                                                \
+                                                                                     \
+    void name##MergeSort(T arr[], int n)                                             \
+    {                                                                                \
+        T *buffer = (T *)malloc((n / 2 + 1) * sizeof(T));                            \
+        name##MergeSortRec(arr, buffer, n);                                          \
+        free(buffer);                                                                \
+    }
+
+#define DEFINE_RADIX_SORT(name, T, KEY_T, KEY)                                       \
+    void name##RadixSort(T arr[], int n)                                             \
+    {                                                                                \
+        enum { PASSES = sizeof(KEY_T) };                                             \
+        if (n < 2)                                                                   \
+            return;                                                                  \
+        size_t count[PASSES][256];                                                   \
+        memset(count, 0, sizeof(count));                                             \
+        for (int i = 0; i < n; i++)                                                  \
+        {                                                                            \
+            KEY_T k = KEY(arr[i]);                                                   \
+            for (int p = 0; p < PASSES; p++)                                         \
+                count[p][(k >> (8 * p)) & 0xFF]++;                                   \
+        }                                                                            \
+        T *buffer = (T *)malloc(n * sizeof(T));                                      \
+        T *src = arr, *dst = buffer;                                                 \
+        for (int p = 0; p < PASSES; p++)                                             \
+        {                                                                            \
+            int shift = 8 * p;                                                       \
+            if (count[p][(KEY(src[0]) >> shift) & 0xFF] == (size_t)n)                \
+                continue;                                                            \
+            size_t sum = 0;                                                          \
+            for (int b = 0; b < 256; b++)                                            \
+            {                                                                        \
+                size_t t = count[p][b];                                              \
+                count[p][b] = sum;                                                   \
+                sum += t;                                                            \
+            }                                                                        \
+            for (int i = 0; i < n; i++)                                              \
+                dst[count[p][(KEY(src[i]) >> shift) & 0xFF]++] = src[i];             \
+            T *t = src;                                                              \
+            src = dst;                                                               \
+            dst = t;                                                                 \
+        }                                                                            \
+        if (src != arr)                                                              \
+            memcpy(arr, src, n * sizeof(T));                                         \
+        free(buffer);                                                                \
+    }
+
+// Stable Sort
+// DEFINE_STABLE_SORT(name, T, LESS) adds nameStableSort(T arr[], int n): a bottom-up merge sort
+// over insertion-sorted runs of STABLE_MIN_RUN that needs only n / STABLE_BUFFER_RATIO elements of
+// buffer. Neighbouring runs that are already in order are not touched, so sorted input costs one
+// comparison per run. A merge whose shorter run fits the buffer copies that run out and merges
+// towards it; otherwise the longer run is cut in half, the matching cut in the other run is found
+// by binary search, the two middle pieces are swapped by rotation, and both halves are merged
+// again. Equal elements never cross each other, so the sort is stable.
+// nameMergeAdaptive(arr, mid, n, buffer, bufferSize) is that merge of arr[0..mid) and arr[mid..n).
+#define STABLE_MIN_RUN 32
+#define STABLE_BUFFER_RATIO 8
+
+#define DEFINE_STABLE_SORT(name, T, LESS)                                            \
+    void name##Reverse(T arr[], int n)                                               \
+    {                                                                                \
+        for (int lo = 0, hi = n - 1; lo < hi; lo++, hi--)                            \
+        {                                                                            \
+            T temp = arr[lo];                                                        \
+            arr[lo] = arr[hi];                                                       \
+            arr[hi] = temp;                                                          \
+        }                                                                            \
+    }                                                                                \
+                                                                                     \
+    /* arr[0..k) and arr[k..n) swap places */                                        \
+    void name##Rotate(T arr[], int n, int k)                                         \
+    {                                                                                \
+        if (k == 0 || k == n)                                                        \
+            return;                                                                  \
+        name##Reverse(arr, k);                                                       \
+        name##Reverse(arr + k, n - k);                                               \
+        name##Reverse(arr, n);                                                       \
+    }                                                                                \
+                                                                                     \
+    /* First position in sorted arr[0..n) whose element is not less than value */   \
+    int name##LowerBound(const T arr[], int n, T value)                              \
+    {                                                                                \
+        int lo = 0;                                                                  \
+        while (n > 0)                                                                \
+        {                                                                            \
+            int half = n / 2;                                                        \
+            if (LESS(arr[lo + half], value))                                         \
+            {                                                                        \
+                lo += half + 1;                                                      \
+                n -= half + 1;                                                       \
+            }                                                                        \
+            else                                                                     \
+                n = half;                                                            \
+        }                                                                            \
+        return lo;                                                                   \
+    }                                                                                \
+                                                                                     \
+    /* First position in sorted arr[0..n) whose element is greater than value */     \
+    int name##UpperBound(const T arr[], int n, T value)                              \
+    {                                                                                \
+        int lo = 0;                                                                  \
+        while (n > 0)                                                                \
+        {                                                                            \
+            int half = n / 2;                                                        \
+            if (!LESS(value, arr[lo + half]))                                        \
+            {                                                                        \
+                lo += half + 1;                                                      \
+                n -= half + 1;                                                       \
+            }                                                                        \
+            else                                                                     \
+                n = half;                                                            \
+        }                                                                            \
+        return lo;                                                                   \
+    }                                                                                \
+                                                                                     \
+    void name##MergeAdaptive(T arr[], int mid, int n, T buffer[], int bufferSize)    \
+    {                                                                                \
+        while (mid > 0 && mid < n && LESS(arr[mid], arr[mid - 1]))                   \
+        {                                                                            \
+            if (mid <= n - mid && mid <= bufferSize)                                 \
+            {                                                                        \
+                memcpy(buffer, arr, mid * sizeof(T));                                \
+                int i = 0, j = mid, k = 0;                                           \
+                while (i < mid && j < n)                                             \
+                    arr[k++] = LESS(arr[j], buffer[i]) ? arr[j++] : buffer[i++];     \
+                while (i < mid)                                                      \
+                    arr[k++] = buffer[i++];                                          \
+                return;                                                              \
+            }                                                                        \
+            if (n - mid <= bufferSize)                                               \
+            {                                                                        \
+                memcpy(buffer, arr + mid, (n - mid) * sizeof(T));                    \
+                int i = mid - 1, j = n - mid - 1, k = n - 1;                         \
+                while (i >= 0 && j >= 0)                                             \
+                    arr[k--] = LESS(buffer[j], arr[i]) ? arr[i--] : buffer[j--];     \
+                while (j >= 0)                                                       \
+                    arr[k--] = buffer[j--];                                          \
+                return;                                                              \
+            }                                                                        \
+            if (n == 2)                                                              \
+            {                                                                        \
+                T temp = arr[0];                                                     \
+                arr[0] = arr[1];                                                     \
+                arr[1] = temp;                                                       \
+                return;                                                              \
+            }                                                                        \
+                                                                                     \
+            int cut1, cut2;                                                          \
+            if (mid > n - mid)                                                       \
+            {                                                                        \
+                cut1 = mid / 2;                                                      \
+                cut2 = mid + name##LowerBound(arr + mid, n - mid, arr[cut1]);        \
+            }                                                                        \
+            else                                                                     \
+            {                                                                        \
+                cut2 = mid + (n - mid) / 2;                                          \
+                cut1 = name##UpperBound(arr, mid, arr[cut2]);                        \
+            }                                                                        \
+            name##Rotate(arr + cut1, cut2 - cut1, mid - cut1);                       \
+            int newMid = cut1 + (cut2 - mid);                                        \
+            /* Recurse into the smaller side, loop on the larger */                  \
+            if (newMid < n - newMid)                                                 \
+            {                                                                        \
+                name##MergeAdaptive(arr, cut1, newMid, buffer, bufferSize);          \
+                arr += newMid;                                                       \
+                n -= newMid;                                                         \
+                mid = mid - cut1;                                                    \
+            }                                                                        \
+            else                                                                     \
+            {                                                                        \
+                name##MergeAdaptive(arr + newMid, mid - cut1, n - newMid, buffer,    \
+                                    bufferSize);                                     \
+                n = newMid;                                                          \
+                mid = cut1;                                                          \
+            }                                                                        \
+        }                                                                            \
+    }                                                                                \
+                                                                                     \
+    void name##MergeSortBuffered(T arr[], int n, T buffer[], int bufferSize)         \
+    {                                                                                \
+        for (int lo = 0; lo < n; lo += STABLE_MIN_RUN)                               \
+        {                                                                            \
+            int len = n - lo < STABLE_MIN_RUN ? n - lo : STABLE_MIN_RUN;             \
+            for (int i = lo + 1; i < lo + len; i++)                                  \
+            {                                                                        \
+                T key = arr[i];                                                      \
+                int j = i - 1;                                                       \
+                while (j >= lo && LESS(key, arr[j]))                                 \
+                {                                                                    \
+                    arr[j + 1] = arr[j];                                             \
+                    j--;                                                             \
+                }                                                                    \
+                arr[j + 1] = key;                                                    \
+            }                                                                        \
+        }                                                                            \
+        for (long long width = STABLE_MIN_RUN; width < n; width *= 2)                \
+            for (long long lo = 0; lo + width < n; lo += 2 * width)                  \
+            {                                                                        \
+                int len = (int)(n - lo < 2 * width ? n - lo : 2 * width);            \
+                name##MergeAdaptive(arr + lo, (int)width, len, buffer, bufferSize);  \
+            }                                                                        \
+    }                                                                                \
+                                                                                     \
+    void name##StableSort(T arr[], int n)                                            \
+    {                                                                                \
+        if (n < 2)                                                                   \
+            return;                                                                  \
+        int bufferSize = n / STABLE_BUFFER_RATIO + 1;                                \
+        T *buffer = (T *)malloc(bufferSize * sizeof(T));                             \
+        name##MergeSortBuffered(arr, n, buffer, bufferSize);                         \
+        free(buffer);                                                                \
+    }
+
+// Order-preserving unsigned keys: flip the sign bit of integers; for IEEE floats flip every
+// bit of negatives (reversing their order) and only the sign bit of positives. The float keys
+// give a total order, -inf < ... < -0.0 < +0.0 < ... < +inf < NaN: a NaN loses its sign bit
+// first, so NaNs of either sign sort last, by payload.
+static inline uint64_t int64Key(int64_t x)
+{
+    return (uint64_t)x ^ 0x8000000000000000ull;
+}
+
+static inline uint32_t floatKey(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    u &= ~((uint32_t)((u & 0x7FFFFFFFu) > 0x7F800000u) << 31);
+    return u ^ (-(u >> 31) | 0x80000000u);
+}
+
+static inline uint64_t doubleKey(double d)
+{
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    u &= ~((uint64_t)((u & 0x7FFFFFFFFFFFFFFFull) > 0x7FF0000000000000ull) << 63);
+    return u ^ (-(u >> 63) | 0x8000000000000000ull);
+}
+
+// Fixed-size record sorted by a 64-bit key field
+typedef struct
+{
+    uint64_t key;
+    char payload[24];
+} Record;
+
+// Key/payload pair
+typedef struct
+{
+    uint32_t key;
+    uint32_t value;
+} KeyValue;
+
+// Int key with its input position, for checking stability
+typedef struct
+{
+    int key;
+    int tag;
+} TaggedRecord;
+
+#define LESS_VALUE(a, b) ((a) < (b))
+#define LESS_KEY(a, b) ((a).key < (b).key)
+#define IDENTITY_KEY(x) (x)
+#define FIELD_KEY(x) ((x).key)
+#define SIGNED_FIELD_KEY(x) ((uint32_t)(x).key ^ 0x80000000u)
+
+DEFINE_SORTS(int64, int64_t, LESS_VALUE)
+DEFINE_RADIX_SORT(int64, int64_t, uint64_t, int64Key)
+DEFINE_SORTS(uint64, uint64_t, LESS_VALUE)
+DEFINE_RADIX_SORT(uint64, uint64_t, uint64_t, IDENTITY_KEY)
+DEFINE_SORTS(uint32, uint32_t, LESS_VALUE)
+DEFINE_SORTS(float, float, LESS_VALUE)
+DEFINE_RADIX_SORT(float, float, uint32_t, floatKey)
+DEFINE_SORTS(double, double, LESS_VALUE)
+DEFINE_RADIX_SORT(double, double, uint64_t, doubleKey)
+DEFINE_SORTS(record, Record, LESS_KEY)
+DEFINE_RADIX_SORT(record, Record, uint64_t, FIELD_KEY)
+DEFINE_SORTS(keyValue, KeyValue, LESS_KEY)
+DEFINE_RADIX_SORT(keyValue, KeyValue, uint32_t, FIELD_KEY)
+DEFINE_STABLE_SORT(int, int, LESS_VALUE)
+DEFINE_SORTS(tagged, TaggedRecord, LESS_KEY)
+DEFINE_RADIX_SORT(tagged, TaggedRecord, uint32_t, SIGNED_FIELD_KEY)
+DEFINE_STABLE_SORT(tagged, TaggedRecord, LESS_KEY)
+
+// In-Place Merge Sort
+// Same signature as mergeSort, but the merges borrow only sqrt(n) elements of buffer (at least
+// INPLACE_MIN_BUFFER) instead of two n/2 halves: merges that do not fit are split by binary search
+// and rotation until their shorter run does. Stable, O(sqrt n) extra memory plus an O(log n) stack.
+#define INPLACE_MIN_BUFFER 64
+
+void inPlaceMergeSort(int arr[], int l, int r)
+{
+    int n = r - l + 1;
+    if (n < 2)
+        return;
+    int bufferSize = (int)sqrt((double)n);
+    if (bufferSize < INPLACE_MIN_BUFFER)
+        bufferSize = INPLACE_MIN_BUFFER;
+    int *buffer = (int *)malloc(bufferSize * sizeof(int));
+    intMergeSortBuffered(arr + l, n, buffer, bufferSize);
+    free(buffer);
+}
+
+// Pattern-Defeating Quick Sort
+// Block-based branchless partitioning (BlockQuicksort): element positions on the wrong side are
+// recorded into small offset buffers without branching, then swapped in bulk. Already partitioned
+// ranges are finished with a bounded insertion sort, unbalanced partitions shuffle a few elements
+// to break patterns, and after log2(n) bad partitions the range falls back to heapSort.
+#define PDQ_INSERTION_THRESHOLD 24
+#define PDQ_NINTHER_THRESHOLD 128
+#define PDQ_PARTIAL_INSERTION_LIMIT 8
+#define PDQ_BLOCK_SIZE 64
+
+static inline void swapPtr(int *a, int *b)
+{
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+static inline void sort2(int *a, int *b)
+{
+    if (*b < *a)
+        swapPtr(a, b);
+}
+
+static inline void sort3(int *a, int *b, int *c)
+{
+    sort2(a, b);
+    sort2(b, c);
+    sort2(a, b);
+}
+
+// unguarded: the element before begin is known to be <= everything in [begin, end)
+void pdqInsertionSort(int *begin, int *end, int unguarded)
+{
+    if (begin == end)
+        return;
+    for (int *cur = begin + 1; cur != end; cur++)
+    {
+        int *sift = cur, *sift1 = cur - 1;
+        if (*sift < *sift1)
+        {
+            int temp = *sift;
+            do
+                *sift-- = *sift1;
+            while ((unguarded || sift != begin) && temp < *--sift1);
+            *sift = temp;
+        }
+    }
+}
+
+// Gives up (returning 0) once more than PDQ_PARTIAL_INSERTION_LIMIT elements have moved
+int pdqPartialInsertionSort(int *begin, int *end)
+{
+    if (begin == end)
+        return 1;
+    long moved = 0;
+    for (int *cur = begin + 1; cur != end; cur++)
+    {
+        int *sift = cur, *sift1 = cur - 1;
+        if (*sift < *sift1)
+        {
+            int temp = *sift;
+            do
+                *sift-- = *sift1;
+            while (sift != begin && temp < *--sift1);
+            *sift = temp;
+            moved += cur - sift;
+        }
+        if (moved > PDQ_PARTIAL_INSERTION_LIMIT)
+            return 0;
+    }
+    return 1;
+}
+
+void pdqSwapOffsets(int *first, int *last, unsigned char *offsetsL, unsigned char *offsetsR, int num, int useSwaps)
+{
+    if (useSwaps)
+    {
+        for (int i = 0; i < num; i++)
+            swapPtr(first + offsetsL[i], last - offsetsR[i]);
+    }
+    else if (num > 0)
+    {
+        // One cyclic permutation instead of num swaps
+        int *l = first + offsetsL[0], *r = last - offsetsR[0];
+        int temp = *l;
+        *l = *r;
+        for (int i = 1; i < num; i++)
+        {
+            l = first + offsetsL[i];
+            *r = *l;
+            r = last - offsetsR[i];
+            *l = *r;
+        }
+        *r = temp;
+    }
+}
+
+// Partitions [begin, end) around *begin: elements < pivot go left, >= pivot go right.
+// Returns the pivot position; *alreadyPartitioned is set when no element had to move.
+int *pdqPartitionRight(int *begin, int *end, int *alreadyPartitioned)
+{
+    int pivot = *begin;
+    int *first = begin, *last = end;
+
+    // The median-of-three guarantees an element >= pivot exists
+    while (*++first < pivot)
+        ;
+    if (first - 1 == begin)
+        while (first < last && !(*--last < pivot))
+            ;
+    else
+        while (!(*--last < pivot))
+            ;
+
+    *alreadyPartitioned = first >= last;
+    if (!*alreadyPartitioned)
+    {
+        swapPtr(first, last);
+        first++;
+
+        unsigned char offsetsL[PDQ_BLOCK_SIZE], offsetsR[PDQ_BLOCK_SIZE];
+        int *offsetsLBase = first, *offsetsRBase = last;
+        int numL = 0, numR = 0, startL = 0, startR = 0;
+
+        while (first < last)
+        {
+            int numUnknown = (int)(last - first);
+            int leftSplit = numL == 0 ? (numR == 0 ? numUnknown / 2 : numUnknown) : 0;
+            int rightSplit = numR == 0 ? numUnknown - leftSplit : 0;
+
+            // Record offsets unconditionally; only the counter depends on the comparison
+            if (leftSplit >= PDQ_BLOCK_SIZE)
+                leftSplit = PDQ_BLOCK_SIZE;
+            for (int i = 0; i < leftSplit; i++)
+            {
+                offsetsL[numL] = (unsigned char)i;
+                numL += !(*first < pivot);
+                first++;
+            }
+
+            if (rightSplit >= PDQ_BLOCK_SIZE)
+                rightSplit = PDQ_BLOCK_SIZE;
+            for (int i = 0; i < rightSplit;)
+            {
+                offsetsR[numR] = (unsigned char)++i;
+                numR += *--last < pivot;
+            }
+
+            int num = numL < numR ? numL : numR;
+            pdqSwapOffsets(offsetsLBase, offsetsRBase, offsetsL + startL, offsetsR + startR, num, numL == numR);
+            numL -= num;
+            numR -= num;
+            startL += num;
+            startR += num;
+
+            if (numL == 0)
+            {
+                startL = 0;
+                offsetsLBase = first;
+            }
+            if (numR == 0)
+            {
+                startR = 0;
+                offsetsRBase = last;
+            }
+        }
+
+        // One side still has misplaced elements; move them across the boundary
+        if (numL)
+        {
+            unsigned char *offsets = offsetsL + startL;
+            while (numL--)
+                swapPtr(offsetsLBase + offsets[numL], --last);
+            first = last;
+        }
+        if (numR)
+        {
+            unsigned char *offsets = offsetsR + startR;
+            while (numR--)
+            {
+                swapPtr(offsetsRBase - offsets[numR], first);
+                first++;
+            }
+        }
+    }
+
+    int *pivotPos = first - 1;
+    *begin = *pivotPos;
+    *pivotPos = pivot;
+    return pivotPos;
+}
+
+// Puts elements equal to the pivot on the left; used when the pivot equals the element before begin
+int *pdqPartitionLeft(int *begin, int *end)
+{
+    int pivot = *begin;
+    int *first = begin, *last = end;
+
+    while (pivot < *--last)
+        ;
+    if (last + 1 == end)
+        while (first < last && !(pivot < *++first))
+            ;
+    else
+        while (!(pivot < *++first))
+            ;
+
+    while (first < last)
+    {
+        swapPtr(first, last);
+        while (pivot < *--last)
+            ;
+        while (!(pivot < *++first))
+            ;
+    }
+
+    *begin = *last;
+    *last = pivot;
+    return last;
+}
+
+void pdqSortLoop(int *begin, int *end, int badAllowed, int leftmost)
+{
+    for (;;)
+    {
+        long size = end - begin;
+        if (size < PDQ_INSERTION_THRESHOLD)
+        {
+            pdqInsertionSort(begin, end, !leftmost);
+            return;
+        }
+
+        // Median of three, or Tukey's ninther for larger ranges, moved to *begin
+        long s2 = size / 2;
+        if (size > PDQ_NINTHER_THRESHOLD)
+        {
+            sort3(begin, begin + s2, end - 1);
+            sort3(begin + 1, begin + (s2 - 1), end - 2);
+            sort3(begin + 2, begin + (s2 + 1), end - 3);
+            sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1));
+            swapPtr(begin, begin + s2);
+        }
+        else
+            sort3(begin + s2, begin, end - 1);
+
+        // No element here is smaller than *(begin - 1); if the pivot equals it, every element
+        // equal to the pivot can be split off at once and needs no further sorting.
+        if (!leftmost && !(*(begin - 1) < *begin))
+        {
+            begin = pdqPartitionLeft(begin, end) + 1;
+            continue;
+        }
+
+        int alreadyPartitioned;
+        int *pivotPos = pdqPartitionRight(begin, end, &alreadyPartitioned);
+
+        long lSize = pivotPos - begin;
+        long rSize = end - (pivotPos + 1);
+        if (lSize < size / 8 || rSize < size / 8)
+        {
+            if (--badAllowed == 0)
+            {
+                heapSort(begin, (int)size);
+                return;
+            }
+
+            // Swap a few elements into new positions to defeat the input pattern
+            if (lSize >= PDQ_INSERTION_THRESHOLD)
+            {
+                swapPtr(begin, begin + lSize / 4);
+                swapPtr(pivotPos - 1, pivotPos - lSize / 4);
+                if (lSize > PDQ_NINTHER_THRESHOLD)
+                {
+                    swapPtr(begin + 1, begin + (lSize / 4 + 1));
+                    swapPtr(begin + 2, begin + (lSize / 4 + 2));
+                    swapPtr(pivotPos - 2, pivotPos - (lSize / 4 + 1));
+                    swapPtr(pivotPos - 3, pivotPos - (lSize / 4 + 2));
+                }
+            }
+            if (rSize >= PDQ_INSERTION_THRESHOLD)
+            {
+                swapPtr(pivotPos + 1, pivotPos + (1 + rSize / 4));
+                swapPtr(end - 1, end - rSize / 4);
+                if (rSize > PDQ_NINTHER_THRESHOLD)
+                {
+                    swapPtr(pivotPos + 2, pivotPos + (2 + rSize / 4));
+                    swapPtr(pivotPos + 3, pivotPos + (3 + rSize / 4));
+                    swapPtr(end - 2, end - (1 + rSize / 4));
+                    swapPtr(end - 3, end - (2 + rSize / 4));
+                }
+            }
+        }
+        else if (alreadyPartitioned && pdqPartialInsertionSort(begin, pivotPos) &&
+                 pdqPartialInsertionSort(pivotPos + 1, end))
+            return;
+
+        pdqSortLoop(begin, pivotPos, badAllowed, leftmost);
+        begin = pivotPos + 1;
+        leftmost = 0;
+    }
+}
+
+void pdqSort(int arr[], int n)
+{
+    if (n < 2)
+        return;
+    int log2n = 0;
+    for (int m = n; m > 1; m >>= 1)
+        log2n++;
+    pdqSortLoop(arr, arr + n, log2n, 1);
+}
+
+// Natural Merge Sort
+// Uses the runs already present in the input: strictly descending runs are reversed in place,
+// short runs are extended to NATURAL_MIN_RUN with insertion sort, and neighbouring runs are
+// merged pairwise. Sorted or nearly sorted input costs little more than one scan.
+#define NATURAL_MIN_RUN 32
+
+void naturalMergeSort(int arr[], int n)
+{
+    if (n < 2)
+        return;
+
+    int *runStart = (int *)malloc((n / NATURAL_MIN_RUN + 2) * sizeof(int));
+    int numRuns = 0;
+    for (int i = 0; i < n;)
+    {
+        int j = i + 1;
+        if (j < n && arr[j] < arr[i])
+        {
+            while (j < n && arr[j] < arr[j - 1])
+                j++;
+            for (int lo = i, hi = j - 1; lo < hi; lo++, hi--)
+            {
+                int temp = arr[lo];
+                arr[lo] = arr[hi];
+                arr[hi] = temp;
+            }
+        }
+        else
+        {
+            while (j < n && arr[j] >= arr[j - 1])
+                j++;
+        }
+
+        if (j - i < NATURAL_MIN_RUN)
+        {
+            j = i + NATURAL_MIN_RUN < n ? i + NATURAL_MIN_RUN : n;
+            insertionSort(arr + i, j - i);
+        }
+        runStart[numRuns++] = i;
+        i = j;
+    }
+    runStart[numRuns] = n;
+
+    int *buffer = (int *)malloc(n * sizeof(int));
+    while (numRuns > 1)
+    {
+        int merged = 0;
+        for (int r = 0; r < numRuns; r += 2)
+        {
+            int a = runStart[r];
+            if (r + 1 < numRuns)
+            {
+                int b = runStart[r + 1], c = runStart[r + 2];
+                if (arr[b - 1] > arr[b])
+                {
+                    memcpy(buffer, arr + a, (b - a) * sizeof(int));
+                    int i = 0, j = b, k = a, leftEnd = b - a;
+                    while (i < leftEnd && j < c)
+                        arr[k++] = arr[j] < buffer[i] ? arr[j++] : buffer[i++];
+                    while (i < leftEnd)
+                        arr[k++] = buffer[i++];
+                }
+            }
+            runStart[merged++] = a;
+        }
+        runStart[merged] = n;
+        numRuns = merged;
+    }
+
+    free(buffer);
+    free(runStart);
+}
+
+// SIMD Sorting Networks
+// Blocks are sorted with a column sorting network across registers followed by a transpose,
+// then sorted rows are combined with bitonic merges: 8 -> 16 -> 32 -> 64 elements for AVX2,
+// 4 -> 8 -> 16 for SSE4.1. Larger arrays merge sorted blocks with the same bitonic kernel.
+// simdLevel() picks the widest instruction set the CPU supports; SIMD_SCALAR is the fallback.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define SSE41_TARGET __attribute__((target("sse4.1")))
+#endif
+
+enum
+{
+    SIMD_SCALAR,
+    SIMD_SSE41,
+    SIMD_AVX2
+};
+
+const char *simdLevelNames[] = {"scalar", "sse4.1", "avx2"};
+
+// Set to a lower level to force a fallback path (benchmarks use this)
+int simdLevelOverride = -1;
+
+int simdLevel(void)
+{
+    static int detected = -1;
+    if (detected < 0)
+    {
+        detected = SIMD_SCALAR;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            detected = SIMD_AVX2;
+        else if (__builtin_cpu_supports("sse4.1"))
+            detected = SIMD_SSE41;
+#endif
+    }
+    if (simdLevelOverride >= 0 && simdLevelOverride < detected)
+        return simdLevelOverride;
+    return detected;
+}
+
+// Scalar fallback: insertion-sorted blocks, branchless merge
+void scalarSortBlock(int arr[])
+{
+    insertionSort(arr, 16);
+}
+
+void scalarMerge(const int a[], int na, const int b[], int nb, int out[])
+{
+    int i = 0, j = 0, k = 0;
+    while (i < na && j < nb)
+    {
+        int takeB = b[j] < a[i];
+        out[k++] = takeB ? b[j] : a[i];
+        j += takeB;
+        i += !takeB;
+    }
+    while (i < na)
+        out[k++] = a[i++];
+    while (j < nb)
+        out[k++] = b[j++];
+}
+
+#ifdef HAVE_X86_SIMD
+#define AVX2_CMPX(a, b)                        \
+    do                                         \
+    {                                          \
+        __m256i lo_ = _mm256_min_epi32(a, b);  \
+        b = _mm256_max_epi32(a, b);            \
+        a = lo_;                               \
+    } while (0)
+
+AVX2_TARGET static inline __m256i avx2Reverse(__m256i v)
+{
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+// Sorts one bitonic vector of 8 (distances 4, 2, 1)
+AVX2_TARGET static inline __m256i avx2BitonicClean(__m256i v)
+{
+    __m256i p = _mm256_permute2x128_si256(v, v, 1);
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xF0);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xCC);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xAA);
+}
+
+// v[0..count/2) and v[count/2..count) each sorted; merges them into sorted v[0..count)
+AVX2_TARGET static inline void avx2MergeVectors(__m256i v[], int count)
+{
+    int half = count / 2;
+    for (int i = 0; i < half / 2; i++)
+    {
+        __m256i t = v[half + i];
+        v[half + i] = v[count - 1 - i];
+        v[count - 1 - i] = t;
+    }
+    for (int i = half; i < count; i++)
+        v[i] = avx2Reverse(v[i]);
+    for (int i = 0; i < half; i++)
+        AVX2_CMPX(v[i], v[i + half]);
+    for (int step = half / 2; step > 0; step /= 2)
+        for (int i = 0; i < count; i++)
+            if ((i & step) == 0)
+                AVX2_CMPX(v[i], v[i + step]);
+    for (int i = 0; i < count; i++)
+        v[i] = avx2BitonicClean(v[i]);
+}
+
+AVX2_TARGET void avx2SortBlock(int arr[])
+{
+    __m256i r[8];
+    for (int i = 0; i < 8; i++)
+        r[i] = _mm256_loadu_si256((const __m256i *)(arr + 8 * i));
+
+    // 19-comparator network sorts every column
+    AVX2_CMPX(r[0], r[2]);
+    AVX2_CMPX(r[1], r[3]);
+    AVX2_CMPX(r[4], r[6]);
+    AVX2_CMPX(r[5], r[7]);
+    AVX2_CMPX(r[0], r[4]);
+    AVX2_CMPX(r[1], r[5]);
+    AVX2_CMPX(r[2], r[6]);
+    AVX2_CMPX(r[3], r[7]);
+    AVX2_CMPX(r[0], r[1]);
+    AVX2_CMPX(r[2], r[3]);
+    AVX2_CMPX(r[4], r[5]);
+    AVX2_CMPX(r[6], r[7]);
+    AVX2_CMPX(r[2], r[4]);
+    AVX2_CMPX(r[3], r[5]);
+    AVX2_CMPX(r[1], r[4]);
+    AVX2_CMPX(r[3], r[6]);
+    AVX2_CMPX(r[1], r[2]);
+    AVX2_CMPX(r[3], r[4]);
+    AVX2_CMPX(r[5], r[6]);
+
+    // Transpose so each register holds one sorted column
+    __m256i t[8], u[8];
+    for (int i = 0; i < 8; i += 2)
+    {
+        t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4)
+    {
+        u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        r[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+        r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+    }
+
+    for (int i = 0; i < 8; i += 2)
+        avx2MergeVectors(r + i, 2);
+    avx2MergeVectors(r, 4);
+    avx2MergeVectors(r + 4, 4);
+    avx2MergeVectors(r, 8);
+
+    for (int i = 0; i < 8; i++)
+        _mm256_storeu_si256((__m256i *)(arr + 8 * i), r[i]);
+}
+
+// Merges sorted runs whose lengths are multiples of 8, 8 outputs per step
+AVX2_TARGET void avx2Merge(const int a[], int na, const int b[], int nb, int out[])
+{
+    if (na == 0 || nb == 0)
+    {
+        memcpy(out, na ? a : b, (na + nb) * sizeof(int));
+        return;
+    }
+
+    __m256i v[2];
+    v[0] = _mm256_loadu_si256((const __m256i *)a);
+    v[1] = _mm256_loadu_si256((const __m256i *)b);
+    int i = 8, j = 8;
+    for (;;)
+    {
+        avx2MergeVectors(v, 2);
+        _mm256_storeu_si256((__m256i *)out, v[0]);
+        out += 8;
+        if (i < na && (j >= nb || a[i] <= b[j]))
+        {
+            v[0] = _mm256_loadu_si256((const __m256i *)(a + i));
+            i += 8;
+        }
+        else if (j < nb)
+        {
+            v[0] = _mm256_loadu_si256((const __m256i *)(b + j));
+            j += 8;
+        }
+        else
+            break;
+    }
+    _mm256_storeu_si256((__m256i *)out, v[1]);
+}
+
+#define SSE_CMPX(a, b)                      \
+    do                                      \
+    {                                       \
+        __m128i lo_ = _mm_min_epi32(a, b);  \
+        b = _mm_max_epi32(a, b);            \
+        a = lo_;                            \
+    } while (0)
+
+SSE41_TARGET static inline __m128i sseBlend(__m128i a, __m128i b, const int mask)
+{
+    return _mm_castps_si128(_mm_blend_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), mask));
+}
+
+SSE41_TARGET static inline __m128i sseBitonicClean(__m128i v)
+{
+    __m128i p = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = sseBlend(_mm_min_epi32(v, p), _mm_max_epi32(v, p), 0xC);
+    p = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return sseBlend(_mm_min_epi32(v, p), _mm_max_epi32(v, p), 0xA);
+}
+
+SSE41_TARGET static inline void sseMergeVectors(__m128i v[], int count)
+{
+    int half = count / 2;
+    for (int i = 0; i < half / 2; i++)
+    {
+        __m128i t = v[half + i];
+        v[half + i] = v[count - 1 - i];
+        v[count - 1 - i] = t;
+    }
+    for (int i = half; i < count; i++)
+        v[i] = _mm_shuffle_epi32(v[i], _MM_SHUFFLE(0, 1, 2, 3));
+    for (int i = 0; i < half; i++)
+        SSE_CMPX(v[i], v[i + half]);
+    for (int step = half / 2; step > 0; step /= 2)
+        for (int i = 0; i < count; i++)
+            if ((i & step) == 0)
+                SSE_CMPX(v[i], v[i + step]);
+    for (int i = 0; i < count; i++)
+        v[i] = sseBitonicClean(v[i]);
+}
+
+SSE41_TARGET void sseSortBlock(int arr[])
+{
+    __m128i r[4];
+    for (int i = 0; i < 4; i++)
+        r[i] = _mm_loadu_si128((const __m128i *)(arr + 4 * i));
+
+    SSE_CMPX(r[0], r[1]);
+    SSE_CMPX(r[2], r[3]);
+    SSE_CMPX(r[0], r[2]);
+    SSE_CMPX(r[1], r[3]);
+    SSE_CMPX(r[1], r[2]);
+
+    __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]), t1 = _mm_unpackhi_epi32(r[0], r[1]);
+    __m128i t2 = _mm_unpacklo_epi32(r[2], r[3]), t3 = _mm_unpackhi_epi32(r[2], r[3]);
+    r[0] = _mm_unpacklo_epi64(t0, t2);
+    r[1] = _mm_unpackhi_epi64(t0, t2);
+    r[2] = _mm_unpacklo_epi64(t1, t3);
+    r[3] = _mm_unpackhi_epi64(t1, t3);
+
+    sseMergeVectors(r, 2);
+    sseMergeVectors(r + 2, 2);
+    sseMergeVectors(r, 4);
+
+    for (int i = 0; i < 4; i++)
+        _mm_storeu_si128((__m128i *)(arr + 4 * i), r[i]);
+}
+
+SSE41_TARGET void sseMerge(const int a[], int na, const int b[], int nb, int out[])
+{
+    if (na == 0 || nb == 0)
+    {
+        memcpy(out, na ? a : b, (na + nb) * sizeof(int));
+        return;
+    }
+
+    __m128i v[2];
+    v[0] = _mm_loadu_si128((const __m128i *)a);
+    v[1] = _mm_loadu_si128((const __m128i *)b);
+    int i = 4, j = 4;
+    for (;;)
+    {
+        sseMergeVectors(v, 2);
+        _mm_storeu_si128((__m128i *)out, v[0]);
+        out += 4;
+        if (i < na && (j >= nb || a[i] <= b[j]))
+        {
+            v[0] = _mm_loadu_si128((const __m128i *)(a + i));
+            i += 4;
+        }
+        else if (j < nb)
+        {
+            v[0] = _mm_loadu_si128((const __m128i *)(b + j));
+            j += 4;
+        }
+        else
+            break;
+    }
+    _mm_storeu_si128((__m128i *)out, v[1]);
+}
+#endif
+
+// Pads to whole blocks with INT_MAX, sorts each block, then merges runs bottom-up
+#define SIMD_STACK_ELEMENTS 4096
+
+void simdSort(int arr[], int n)
+{
+    if (n < 2)
+        return;
+
+    int block = 16;
+    void (*sortBlock)(int[]) = scalarSortBlock;
+    void (*mergeRuns)(const int[], int, const int[], int, int[]) = scalarMerge;
+#ifdef HAVE_X86_SIMD
+    int level = simdLevel();
+    if (level == SIMD_AVX2)
+    {
+        block = 64;
+        sortBlock = avx2SortBlock;
+        mergeRuns = avx2Merge;
+    }
+    else if (level == SIMD_SSE41)
+    {
+        sortBlock = sseSortBlock;
+        mergeRuns = sseMerge;
+    }
+#endif
+
+    int m = (n + block - 1) / block * block;
+    int stackA[SIMD_STACK_ELEMENTS], stackB[SIMD_STACK_ELEMENTS];
+    int *src = m <= SIMD_STACK_ELEMENTS ? stackA : (int *)malloc(2 * m * sizeof(int));
+    int *dst = m <= SIMD_STACK_ELEMENTS ? stackB : src + m;
+    int *heapBuffer = m <= SIMD_STACK_ELEMENTS ? NULL : src;
+
+    memcpy(src, arr, n * sizeof(int));
+    for (int i = n; i < m; i++)
+        src[i] = INT_MAX;
+
+    for (int lo = 0; lo < m; lo += block)
+        sortBlock(src + lo);
+
+    for (int width = block; width < m; width *= 2)
+    {
+        for (int lo = 0; lo < m; lo += 2 * width)
+        {
+            int mid = lo + width < m ? lo + width : m;
+            int hi = lo + 2 * width < m ? lo + 2 * width : m;
+            mergeRuns(src + lo, mid - lo, src + mid, hi - mid, dst + lo);
+        }
+        int *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    memcpy(arr, src, n * sizeof(int));
+    free(heapBuffer);
+}
+
+// SIMD kernels as the base case of the recursive sorts
+#define SIMD_BASE_CASE 64
+
+void introSortSIMD(int arr[], int n)
+{
+    introSortLoop(arr, 0, n - 1, introDepthLimit(n), SIMD_BASE_CASE, simdSort);
+}
+
+void mergeSortSIMD(int arr[], int l, int r)
+{
+    if (r - l + 1 <= SIMD_BASE_CASE)
+    {
+        simdSort(arr + l, r - l + 1);
+        return;
+    }
+    int m = l + (r - l) / 2;
+    mergeSortSIMD(arr, l, m);
+    mergeSortSIMD(arr, m + 1, r);
+    merge(arr, l, m, r);
+}
+
+// Min/Max Scan
+void scalarMinMax(const int arr[], int n, int *minOut, int *maxOut)
+{
+    int min = INT_MAX, max = INT_MIN;
+    for (int i = 0; i < n; i++)
+    {
+        min = arr[i] < min ? arr[i] : min;
+        max = arr[i] > max ? arr[i] : max;
+    }
+    *minOut = min;
+    *maxOut = max;
+}
+
+#ifdef HAVE_X86_SIMD
+AVX2_TARGET void avx2MinMax(const int arr[], int n, int *minOut, int *maxOut)
+{
+    __m256i vmin = _mm256_set1_epi32(INT_MAX), vmax = _mm256_set1_epi32(INT_MIN);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(arr + i));
+        vmin = _mm256_min_epi32(vmin, v);
+        vmax = _mm256_max_epi32(vmax, v);
+    }
+    int lanesMin[8], lanesMax[8], min, max;
+    _mm256_storeu_si256((__m256i *)lanesMin, vmin);
+    _mm256_storeu_si256((__m256i *)lanesMax, vmax);
+    scalarMinMax(arr + i, n - i, &min, &max);
+    for (int l = 0; l < 8; l++)
+    {
+        min = lanesMin[l] < min ? lanesMin[l] : min;
+        max = lanesMax[l] > max ? lanesMax[l] : max;
+    }
+    *minOut = min;
+    *maxOut = max;
+}
+
+SSE41_TARGET void sseMinMax(const int arr[], int n, int *minOut, int *maxOut)
+{
+    __m128i vmin = _mm_set1_epi32(INT_MAX), vmax = _mm_set1_epi32(INT_MIN);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(arr + i));
+        vmin = _mm_min_epi32(vmin, v);
+        vmax = _mm_max_epi32(vmax, v);
+    }
+    int lanesMin[4], lanesMax[4], min, max;
+    _mm_storeu_si128((__m128i *)lanesMin, vmin);
+    _mm_storeu_si128((__m128i *)lanesMax, vmax);
+    scalarMinMax(arr + i, n - i, &min, &max);
+    for (int l = 0; l < 4; l++)
+    {
+        min = lanesMin[l] < min ? lanesMin[l] : min;
+        max = lanesMax[l] > max ? lanesMax[l] : max;
+    }
+    *minOut = min;
+    *maxOut = max;
+}
+#endif
+
+// For n == 0 the result is min = INT_MAX, max = INT_MIN
+void findMinMax(const int arr[], int n, int *minOut, int *maxOut)
+{
+#ifdef HAVE_X86_SIMD
+    int level = simdLevel();
+    if (level == SIMD_AVX2)
+    {
+        avx2MinMax(arr, n, minOut, maxOut);
+        return;
+    }
+    if (level == SIMD_SSE41)
+    {
+        sseMinMax(arr, n, minOut, maxOut);
+        return;
+    }
+#endif
+    scalarMinMax(arr, n, minOut, maxOut);
+}
+
+// Counting Sort (bounded key range)
+// Counts every value between min and max and writes them back in order: O(n + range).
+// Large inputs are histogrammed by several threads, each into its own histogram, and the
+// output is written back in parallel by value ranges. The histograms may use at most
+// COUNTING_MAX_BYTES; wider key ranges are declined and left to the caller.
+#define COUNTING_MAX_BYTES ((size_t)64 << 20)
+#define PARALLEL_COUNTING_MIN (1 << 18)
+
+typedef struct
+{
+    int *arr;
+    int begin, end, min;
+    uint32_t *hist;
+    size_t range;
+    int firstValue, lastValue;
+    size_t offset;
+} CountingWorker;
+
+void *countingHistogramWorker(void *arg)
+{
+    CountingWorker *w = (CountingWorker *)arg;
+    memset(w->hist, 0, w->range * sizeof(uint32_t));
+    for (int i = w->begin; i < w->end; i++)
+        w->hist[(uint32_t)(w->arr[i] - w->min)]++;
+    return NULL;
+}
+
+void *countingFillWorker(void *arg)
+{
+    CountingWorker *w = (CountingWorker *)arg;
+    int *out = w->arr + w->offset;
+    for (int v = w->firstValue; v < w->lastValue; v++)
+    {
+        int value = w->min + v;
+        for (uint32_t c = w->hist[v]; c > 0; c--)
+            *out++ = value;
+    }
+    return NULL;
+}
+
+// countingSortRange for a caller that already knows the key range
+int countingSortKnownRange(int arr[], int n, int min, int max, int threads)
+{
+    size_t range = (size_t)((long long)max - min) + 1;
+    if (range * sizeof(uint32_t) > COUNTING_MAX_BYTES)
+        return 0;
+
+    if (n < PARALLEL_COUNTING_MIN)
+        threads = 1;
+    while (threads > 1 && (size_t)threads * range * sizeof(uint32_t) > COUNTING_MAX_BYTES)
+        threads--;
+
+    uint32_t *hist = (uint32_t *)malloc((size_t)threads * range * sizeof(uint32_t));
+    CountingWorker *workers = (CountingWorker *)malloc(threads * sizeof(CountingWorker));
+    pthread_t *ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t].arr = arr;
+        workers[t].begin = (int)((long long)n * t / threads);
+        workers[t].end = (int)((long long)n * (t + 1) / threads);
+        workers[t].min = min;
+        workers[t].hist = hist + (size_t)t * range;
+        workers[t].range = range;
+        if (t > 0)
+            pthread_create(&ids[t], NULL, countingHistogramWorker, &workers[t]);
+    }
+    countingHistogramWorker(&workers[0]);
+    for (int t = 1; t < threads; t++)
+    {
+        pthread_join(ids[t], NULL);
+        for (size_t v = 0; v < range; v++)
+            hist[v] += workers[t].hist[v];
+    }
+
+    // Split the value range so that each thread writes about n / threads elements
+    size_t offset = 0;
+    int value = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        size_t target = (size_t)n * (t + 1) / threads;
+        workers[t].hist = hist;
+        workers[t].firstValue = value;
+        workers[t].offset = offset;
+        while ((size_t)value < range && (offset < target || t == threads - 1))
+            offset += hist[value++];
+        workers[t].lastValue = value;
+        if (t > 0)
+            pthread_create(&ids[t], NULL, countingFillWorker, &workers[t]);
+    }
+    countingFillWorker(&workers[0]);
+    for (int t = 1; t < threads; t++)
+        pthread_join(ids[t], NULL);
+
+    free(ids);
+    free(workers);
+    free(hist);
+    return 1;
+}
+
+// Returns 1 when sorted, 0 when the key range is too wide for the memory cap
+int countingSortRange(int arr[], int n, int threads)
+{
+    if (n < 2)
+        return 1;
+
+    int min, max;
+    findMinMax(arr, n, &min, &max);
+    return countingSortKnownRange(arr, n, min, max, threads);
+}
+
+// Table entry: counting sort where the range allows it, radix sort otherwise. The thread count
+// is only looked up (a sysconf call, slower than sorting a small input) when threads are used.
+void boundedCountingSort(int arr[], int n)
+{
+    if (!countingSortRange(arr, n, n >= PARALLEL_COUNTING_MIN ? hardwareThreads() : 1))
+        radixSort(arr, n);
+}
+
+// Helper function to copy arrays
+void copyArray(int src[], int dest[], int n)
+{
+    for (int i = 0; i < n; i++)
+        dest[i] = src[i];
+}
+
+int isSorted(int arr[], int n)
+{
+    for (int i = 1; i < n; i++)
+        if (arr[i - 1] > arr[i])
+            return 0;
+    return 1;
+}
+
+// Wall-clock seconds (clock() adds up CPU time of every thread)
+double wallTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Hardware Performance Counters
+// Counters come from Linux perf_event_open; a counter that cannot be opened (other OS,
+// perf_event_paranoid, containers) reads as unavailable and the run goes on without it.
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+enum
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_EVENT_COUNT
+};
+
+const char *perfEventNames[] = {"cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "dtlb_misses"};
+
+typedef struct
+{
+    int fd[PERF_EVENT_COUNT];
+    uint64_t value[PERF_EVENT_COUNT];
+} PerfCounters;
+
+void perfOpen(PerfCounters *pc)
+{
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+    {
+        pc->fd[e] = -1;
+        pc->value[e] = 0;
+    }
+#ifdef __linux__
+    // Cache events: cache id | operation << 8 | result << 16
+    static const uint32_t types[PERF_EVENT_COUNT] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                     PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+    static const uint64_t configs[PERF_EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[e];
+        attr.config = configs[e];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        pc->fd[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+}
+
+int perfAvailable(const PerfCounters *pc, int event)
+{
+    return pc->fd[event] >= 0;
+}
+
+void perfStart(PerfCounters *pc)
+{
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+        if (pc->fd[e] >= 0)
+        {
+            ioctl(pc->fd[e], PERF_EVENT_IOC_RESET, 0);
+            ioctl(pc->fd[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#else
+    (void)pc;
+#endif
+}
+
+void perfStop(PerfCounters *pc)
+{
+#ifdef __linux__
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+        if (pc->fd[e] >= 0)
+        {
+            ioctl(pc->fd[e], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(pc->fd[e], &pc->value[e], sizeof(uint64_t)) != sizeof(uint64_t))
+                pc->value[e] = 0;
+        }
+#else
+    (void)pc;
+#endif
+}
+
+void perfClose(PerfCounters *pc)
+{
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+        if (pc->fd[e] >= 0)
+        {
+            close(pc->fd[e]);
+            pc->fd[e] = -1;
+        }
+}
+
+// Counter value, or NaN when the counter is unavailable
+double perfValue(const PerfCounters *pc, int event)
+{
+    return perfAvailable(pc, event) ? (double)pc->value[event] : NAN;
+}
+
+// splitmix64: full-width random keys on every platform, unlike rand()
+uint64_t rngState = 0x9E3779B97F4A7C15ull;
+
+uint64_t randomU64(void)
+{
+    uint64_t z = (rngState += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Selection
+// introSelect(arr, n, k) is nth_element: arr[k] becomes the element sorted order puts there,
+// with nothing larger before it and nothing smaller after. It narrows the range with the
+// quick sort partition(); ranges above SELECT_SAMPLE_MIN first select k inside a Floyd-Rivest
+// window so the pivot lands close to rank k, and a spent depth budget falls back to heap
+// selection. partialSort(arr, n, k) leaves the k smallest sorted in arr[0..k); TopK keeps the k
+// smallest of a stream pushed in chunks. The parallel variants split the input between threads.
+#define SELECT_SMALL 16
+#define SELECT_SAMPLE_MIN 600
+#define PARTIAL_HEAP_RATIO 1024 // k below n / 1024: one heap pass beats select + sort
+#define PARALLEL_SELECT_MIN (1 << 20)
+#define PARALLEL_SELECT_SAMPLE 16384
+
+void introSelectRange(int arr[], int left, int right, int k, int depthLimit)
+{
+    while (right > left)
+    {
+        if (right - left < SELECT_SMALL)
+        {
+            insertionSort(arr + left, right - left + 1);
+            return;
+        }
+
+        if (depthLimit-- == 0)
+        {
+            // The max-heap of the k - left + 1 smallest has the answer on top
+            int size = right - left + 1, m = k - left + 1;
+            int top = left;
+            if (m < size)
+                heapSelectSmallest(arr + left, size, m, HEAP_DEFAULT_ARITY);
+            else
+                for (int i = left + 1; i <= right; i++)
+                    top = arr[i] > arr[top] ? i : top;
+            int temp = arr[top];
+            arr[top] = arr[k];
+            arr[k] = temp;
+            return;
+        }
+
+        int pivotIndex;
+        if (right - left > SELECT_SAMPLE_MIN)
+        {
+            // Window of about n^(2/3) elements around k, skewed towards the nearer end
+            double size = right - left + 1, i = k - left + 1;
+            double z = log(size), s = 0.5 * exp(2.0 * z / 3.0);
+            double sd = 0.5 * sqrt(z * s * (size - s) / size) * (i < size / 2 ? -1.0 : 1.0);
+            int newLeft = (int)(k - i * s / size + sd);
+            int newRight = (int)(k + (size - i) * s / size + sd);
+            introSelectRange(arr, newLeft > left ? newLeft : left, newRight < right ? newRight : right, k, depthLimit);
+            pivotIndex = k;
+        }
+        else
+        {
+            int mid = left + (right - left) / 2;
+            sort3(&arr[left], &arr[mid], &arr[right]);
+            pivotIndex = mid;
+        }
+
+        int temp = arr[pivotIndex];
+        arr[pivotIndex] = arr[right];
+        arr[right] = temp;
+        int p = partition(arr, left, right);
+        if (p == k)
+            return;
+
+        if (k > p && p - left < (right - left) / 8)
+        {
+            // Lopsided split, usually a run of duplicates: gather the pivot's equals next to it
+            int q = p;
+            for (int j = p + 1; j <= right; j++)
+            {
+                if (arr[j] == arr[p])
+                {
+                    q++;
+                    temp = arr[q];
+                    arr[q] = arr[j];
+                    arr[j] = temp;
+                }
+            }
+            if (k <= q)
+                return;
+            left = q + 1;
+        }
+        else if (k < p)
+            right = p - 1;
+        else
+            left = p + 1;
+    }
+}
+
+void introSelect(int arr[], int n, int k)
+{
+    if (k < 0 || k >= n)
+        return;
+    introSelectRange(arr, 0, n - 1, k, introDepthLimit(n));
+}
+
+void partialSort(int arr[], int n, int k)
+{
+    if (k > n)
+        k = n;
+    if (k <= 0)
+        return;
+    if ((long long)k * PARTIAL_HEAP_RATIO <= n)
+    {
+        heapPartialSort(arr, n, k);
+        return;
+    }
+    if (k < n)
+        introSelect(arr, n, k - 1);
+    pdqSort(arr, k);
+}
+
+// Streaming top-k: a max-heap of the k smallest values seen so far
+typedef struct
+{
+    int *heap;
+    int k;
+    int size;
+} TopK;
+
+void topKInit(TopK *tk, int k)
+{
+    tk->k = k > 0 ? k : 0;
+    tk->size = 0;
+    tk->heap = (int *)malloc((tk->k > 0 ? tk->k : 1) * sizeof(int));
+}
+
+void topKPush(TopK *tk, const int chunk[], int count)
+{
+    int i = 0;
+    if (tk->size < tk->k)
+    {
+        while (tk->size < tk->k && i < count)
+            tk->heap[tk->size++] = chunk[i++];
+        if (tk->size == tk->k)
+            heapBuild(tk->heap, tk->size, HEAP_DEFAULT_ARITY);
+    }
+    for (; i < count && tk->k > 0; i++)
+        if (chunk[i] < tk->heap[0])
+            heapReplaceTop(tk->heap, tk->k, HEAP_DEFAULT_ARITY, chunk[i]);
+}
+
+// Writes the values kept so far to out in ascending order; returns how many
+int topKResult(const TopK *tk, int out[])
+{
+    memcpy(out, tk->heap, tk->size * sizeof(int));
+    if (tk->size == tk->k)
+        heapDrain(out, tk->size, HEAP_DEFAULT_ARITY);
+    else
+        introSort(out, tk->size);
+    return tk->size;
+}
+
+void topKFree(TopK *tk)
+{
+    free(tk->heap);
+    tk->heap = NULL;
+}
+
+// Parallel Selection
+// Top-k: every thread keeps a TopK of its slice and the t * k survivors are reduced at the end.
+// Select: a sorted random sample gives two values that bracket rank k with high probability;
+// threads count the elements below and between them, copy the in-between ones (a few percent
+// of n) to a buffer, and introSelect finishes there. A missed bracket falls back to a serial select.
+typedef struct
+{
+    const int *arr;
+    int begin;
+    int end;
+    int k;
+    TopK top;
+} TopKWorker;
+
+void *topKWorker(void *arg)
+{
+    TopKWorker *w = (TopKWorker *)arg;
+    topKInit(&w->top, w->k);
+    topKPush(&w->top, w->arr + w->begin, w->end - w->begin);
+    return NULL;
+}
+
+// The min(k, n) smallest elements of arr, ascending, into out; returns the count
+int parallelTopK(const int arr[], int n, int k, int out[], int threads)
+{
+    if (k > n)
+        k = n;
+    if (k <= 0)
+        return 0;
+    if (threads < 1 || n < PARALLEL_SELECT_MIN)
+        threads = 1;
+
+    pthread_t *tids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    TopKWorker *workers = (TopKWorker *)malloc(threads * sizeof(TopKWorker));
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t].arr = arr;
+        workers[t].begin = (int)((long long)n * t / threads);
+        workers[t].end = (int)((long long)n * (t + 1) / threads);
+        workers[t].k = k;
+        pthread_create(&tids[t], NULL, topKWorker, &workers[t]);
+    }
+
+    TopK merged;
+    topKInit(&merged, k);
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(tids[t], NULL);
+        topKPush(&merged, workers[t].top.heap, workers[t].top.size);
+        topKFree(&workers[t].top);
+    }
+    int count = topKResult(&merged, out);
+
+    topKFree(&merged);
+    free(workers);
+    free(tids);
+    return count;
+}
+
+typedef struct
+{
+    const int *arr;
+    int begin;
+    int end;
+    int lo;
+    int hi;
+    long long less;
+    long long middle;
+    int *out; // NULL while counting
+} SelectWorker;
+
+void *selectWorker(void *arg)
+{
+    SelectWorker *w = (SelectWorker *)arg;
+    long long less = 0, middle = 0;
+    for (int i = w->begin; i < w->end; i++)
+    {
+        int x = w->arr[i];
+        if (x < w->lo)
+            less++;
+        else if (x <= w->hi)
+        {
+            if (w->out)
+                w->out[middle] = x;
+            middle++;
+        }
+    }
+    w->less = less;
+    w->middle = middle;
+    return NULL;
+}
+
+void runSelectWorkers(SelectWorker workers[], int threads)
+{
+    pthread_t *tids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    for (int t = 0; t < threads; t++)
+        pthread_create(&tids[t], NULL, selectWorker, &workers[t]);
+    for (int t = 0; t < threads; t++)
+        pthread_join(tids[t], NULL);
+    free(tids);
+}
+
+// Value of rank k (0-based) in arr; arr is not modified
+int parallelSelect(const int arr[], int n, int k, int threads)
+{
+    if (k < 0 || k >= n)
+        return 0;
+
+    int *buffer = NULL;
+    int size = 0, rank = k;
+    if (threads > 1 && n >= PARALLEL_SELECT_MIN)
+    {
+        int s = PARALLEL_SELECT_SAMPLE, delta = 2 * (int)sqrt((double)PARALLEL_SELECT_SAMPLE);
+        int *sample = (int *)malloc(s * sizeof(int));
+        for (int i = 0; i < s; i++)
+            sample[i] = arr[randomU64() % n];
+        introSort(sample, s);
+        int r = (int)((double)k * s / n);
+        int lo = r - delta >= 0 ? sample[r - delta] : INT_MIN;
+        int hi = r + delta < s ? sample[r + delta] : INT_MAX;
+        free(sample);
+
+        SelectWorker *workers = (SelectWorker *)calloc(threads, sizeof(SelectWorker));
+        for (int t = 0; t < threads; t++)
+        {
+            workers[t].arr = arr;
+            workers[t].begin = (int)((long long)n * t / threads);
+            workers[t].end = (int)((long long)n * (t + 1) / threads);
+            workers[t].lo = lo;
+            workers[t].hi = hi;
+        }
+        runSelectWorkers(workers, threads);
+
+        long long less = 0, middle = 0;
+        for (int t = 0; t < threads; t++)
+        {
+            less += workers[t].less;
+            middle += workers[t].middle;
+        }
+        if (less <= k && k < less + middle)
+        {
+            buffer = (int *)malloc(middle * sizeof(int));
+            long long offset = 0;
+            for (int t = 0; t < threads; t++)
+            {
+                workers[t].out = buffer + offset;
+                offset += workers[t].middle;
+            }
+            runSelectWorkers(workers, threads);
+            size = (int)middle;
+            rank = (int)(k - less);
+        }
+        free(workers);
+    }
+
+    if (buffer == NULL)
+    {
+        buffer = (int *)malloc(n * sizeof(int));
+        memcpy(buffer, arr, n * sizeof(int));
+        size = n;
+    }
+    introSelect(buffer, size, rank);
+    int value = buffer[rank];
+    free(buffer);
+    return value;
+}
+
+// partialSort with the selection done by threads: find the k-th value in parallel, move
+// everything below it (then enough copies of it) to the front, and sort that prefix
+void parallelPartialSort(int arr[], int n, int k, int threads)
+{
+    if (k > n)
+        k = n;
+    if (k <= 0)
+        return;
+    if (threads < 2 || n < PARALLEL_SELECT_MIN)
+    {
+        partialSort(arr, n, k);
+        return;
+    }
+
+    int *smallest = NULL;
+    int value;
+    if ((long long)k * PARTIAL_HEAP_RATIO <= n)
+    {
+        smallest = (int *)malloc(k * sizeof(int));
+        parallelTopK(arr, n, k, smallest, threads);
+        value = smallest[k - 1];
+    }
+    else
+        value = parallelSelect(arr, n, k - 1, threads);
+
+    int front = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int i = front; i < n && front < k; i++)
+        {
+            if (pass == 0 ? arr[i] < value : arr[i] == value)
+            {
+                int temp = arr[front];
+                arr[front++] = arr[i];
+                arr[i] = temp;
+            }
+        }
+    }
+
+    if (smallest)
+    {
+        memcpy(arr, smallest, k * sizeof(int));
+        free(smallest);
+    }
+    else
+        parallelRadixSort(arr, k, threads);
+}
+
+// Argsort and Key/Payload Sorts
+// argsort() finds the permutation that sorts the keys without touching any payload: each key is
+// paired with its index and the pairs are sorted by one of three families (radix: LSD passes
+// over key and index arrays, merge: stable merge sort, intro: introsort). Payloads of any size
+// are then moved once with a prefetched gather, out[i] = in[idx[i]], instead of on every swap
+// or scatter pass. Struct-of-arrays keeps keys and payloads apart (sortKeysWithPayload);
+// array-of-structs sorts records that carry their int key at keyOffset (sortRecordsByKey).
+enum
+{
+    SORT_FAMILY_RADIX,
+    SORT_FAMILY_MERGE,
+    SORT_FAMILY_INTRO,
+    SORT_FAMILY_COUNT
+};
+
+const char *sortFamilyNames[] = {"radix", "merge", "intro"};
+
+#define GATHER_PREFETCH 16
+
+// Fills idx so that keys[idx[0]] <= keys[idx[1]] <= ...; sortedKeys (may be NULL or keys
+// itself) receives the keys in that order. Merge and radix keep equal keys in input order.
+void argsort(const int keys[], int n, int idx[], int sortedKeys[], int family)
+{
+    if (family == SORT_FAMILY_RADIX)
+    {
+        int *work = sortedKeys ? sortedKeys : (int *)malloc(n * sizeof(int));
+        if (work != keys)
+            memcpy(work, keys, n * sizeof(int));
+        for (int i = 0; i < n; i++)
+            idx[i] = i;
+        radixSortPairs(work, idx, n);
+        if (work != sortedKeys)
+            free(work);
+        return;
+    }
+
+    const uint32_t flip = 0x80000000u;
+    KeyValue *pairs = (KeyValue *)malloc(n * sizeof(KeyValue));
+    for (int i = 0; i < n; i++)
+    {
+        pairs[i].key = (uint32_t)keys[i] ^ flip;
+        pairs[i].value = (uint32_t)i;
+    }
+    if (family == SORT_FAMILY_MERGE)
+        keyValueMergeSort(pairs, n);
+    else
+        keyValueIntroSort(pairs, n);
+    for (int i = 0; i < n; i++)
+    {
+        idx[i] = (int)pairs[i].value;
+        if (sortedKeys)
+            sortedKeys[i] = (int)(pairs[i].key ^ flip);
+    }
+    free(pairs);
+}
+
+static inline __attribute__((always_inline)) void gatherFixed(char *dst, const char *src, const int idx[], int n,
+                                                              const size_t size)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (i + GATHER_PREFETCH < n)
+            __builtin_prefetch(src + (size_t)idx[i + GATHER_PREFETCH] * size);
+        memcpy(dst + (size_t)i * size, src + (size_t)idx[i] * size, size);
+    }
+}
+
+// dst[i] = src[idx[i]] for elements of size bytes; common sizes get a fixed-size copy
+void gatherPayload(void *dst, const void *src, const int idx[], int n, size_t size)
+{
+    switch (size)
+    {
+    case 8:
+        gatherFixed((char *)dst, (const char *)src, idx, n, 8);
+        break;
+    case 16:
+        gatherFixed((char *)dst, (const char *)src, idx, n, 16);
+        break;
+    case 32:
+        gatherFixed((char *)dst, (const char *)src, idx, n, 32);
+        break;
+    case 64:
+        gatherFixed((char *)dst, (const char *)src, idx, n, 64);
+        break;
+    default:
+        gatherFixed((char *)dst, (const char *)src, idx, n, size);
+        break;
+    }
+}
+
+// Struct-of-arrays: sorts keys and moves payload[i] (payloadSize bytes each) along with keys[i]
+void sortKeysWithPayload(int keys[], void *payload, int n, size_t payloadSize, int family)
+{
+    int *idx = (int *)malloc(n * sizeof(int));
+    void *scratch = malloc((size_t)n * payloadSize);
+    argsort(keys, n, idx, keys, family);
+    gatherPayload(scratch, payload, idx, n, payloadSize);
+    memcpy(payload, scratch, (size_t)n * payloadSize);
+    free(scratch);
+    free(idx);
+}
+
+// Array-of-structs: sorts n records of recordSize bytes by the int stored at keyOffset
+void sortRecordsByKey(void *records, int n, size_t recordSize, size_t keyOffset, int family)
+{
+    int *keys = (int *)malloc(n * sizeof(int));
+    int *idx = (int *)malloc(n * sizeof(int));
+    void *scratch = malloc((size_t)n * recordSize);
+    for (int i = 0; i < n; i++)
+        memcpy(&keys[i], (char *)records + (size_t)i * recordSize + keyOffset, sizeof(int));
+    argsort(keys, n, idx, NULL, family);
+    gatherPayload(scratch, records, idx, n, recordSize);
+    memcpy(records, scratch, (size_t)n * recordSize);
+    free(scratch);
+    free(idx);
+    free(keys);
+}
+
+// Floating-Point Sorting
+// Sorts floats and doubles in the total order of floatKey/doubleKey: -inf < ... < -0.0 < +0.0
+// < ... < +inf < NaN. A SIMD prescan finds the smallest and largest non-NaN values and counts
+// the NaNs in one pass. NaNs are moved to the end and ordered among themselves by payload; the
+// rest are sorted by their unsigned keys. Keys between key(min) and key(max) agree on every
+// byte above the highest one where those two differ, so the radix family histograms and
+// scatters only the bytes below it. The merge and intro families turn the values into keys,
+// sort them as integers and turn them back, so -0.0 and +0.0 come out in order even though
+// they compare equal as floats.
+
+// Scalar prescan: a NaN fails both comparisons, so it never becomes min or max. Returns the
+// number of NaNs; with no other values min = +inf and max = -inf.
+int scalarDoublePrescan(const double arr[], int n, double *minOut, double *maxOut)
+{
+    double min = INFINITY, max = -INFINITY;
+    int nans = 0;
+    for (int i = 0; i < n; i++)
+    {
+        double v = arr[i];
+        min = v < min ? v : min;
+        max = v > max ? v : max;
+        nans += v != v;
+    }
+    *minOut = min;
+    *maxOut = max;
+    return nans;
+}
+
+int scalarFloatPrescan(const float arr[], int n, float *minOut, float *maxOut)
+{
+    float min = INFINITY, max = -INFINITY;
+    int nans = 0;
+    for (int i = 0; i < n; i++)
+    {
+        float v = arr[i];
+        min = v < min ? v : min;
+        max = v > max ? v : max;
+        nans += v != v;
+    }
+    *minOut = min;
+    *maxOut = max;
+    return nans;
+}
+
+#ifdef HAVE_X86_SIMD
+// min/max return their second operand when either one is NaN, so a NaN lane in v leaves the
+// running vmin/vmax alone. The unordered compare is all ones (-1) for a NaN, which is
+// subtracted from the per-lane count.
+AVX2_TARGET int avx2DoublePrescan(const double arr[], int n, double *minOut, double *maxOut)
+{
+    __m256d vmin = _mm256_set1_pd(INFINITY), vmax = _mm256_set1_pd(-INFINITY);
+    __m256i vnan = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d v = _mm256_loadu_pd(arr + i);
+        vmin = _mm256_min_pd(v, vmin);
+        vmax = _mm256_max_pd(v, vmax);
+        vnan = _mm256_sub_epi64(vnan, _mm256_castpd_si256(_mm256_cmp_pd(v, v, _CMP_UNORD_Q)));
+    }
+    double lanesMin[4], lanesMax[4], min, max;
+    long long lanesNan[4];
+    _mm256_storeu_pd(lanesMin, vmin);
+    _mm256_storeu_pd(lanesMax, vmax);
+    _mm256_storeu_si256((__m256i *)lanesNan, vnan);
+    int nans = scalarDoublePrescan(arr + i, n - i, &min, &max);
+    for (int l = 0; l < 4; l++)
+    {
+        min = lanesMin[l] < min ? lanesMin[l] : min;
+        max = lanesMax[l] > max ? lanesMax[l] : max;
+        nans += (int)lanesNan[l];
+    }
+    *minOut = min;
+    *maxOut = max;
+    return nans;
+}
+
+AVX2_TARGET int avx2FloatPrescan(const float arr[], int n, float *minOut, float *maxOut)
+{
+    __m256 vmin = _mm256_set1_ps(INFINITY), vmax = _mm256_set1_ps(-INFINITY);
+    __m256i vnan = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 v = _mm256_loadu_ps(arr + i);
+        vmin = _mm256_min_ps(v, vmin);
+        vmax = _mm256_max_ps(v, vmax);
+        vnan = _mm256_sub_epi32(vnan, _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+    }
+    float lanesMin[8], lanesMax[8], min, max;
+    int lanesNan[8];
+    _mm256_storeu_ps(lanesMin, vmin);
+    _mm256_storeu_ps(lanesMax, vmax);
+    _mm256_storeu_si256((__m256i *)lanesNan, vnan);
+    int nans = scalarFloatPrescan(arr + i, n - i, &min, &max);
+    for (int l = 0; l < 8; l++)
+    {
+        min = lanesMin[l] < min ? lanesMin[l] : min;
+        max = lanesMax[l] > max ? lanesMax[l] : max;
+        nans += lanesNan[l];
+    }
+    *minOut = min;
+    *maxOut = max;
+    return nans;
+}
+
+SSE41_TARGET int sseDoublePrescan(const double arr[], int n, double *minOut, double *maxOut)
+{
+    __m128d vmin = _mm_set1_pd(INFINITY), vmax = _mm_set1_pd(-INFINITY);
+    __m128i vnan = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d v = _mm_loadu_pd(arr + i);
+        vmin = _mm_min_pd(v, vmin);
+        vmax = _mm_max_pd(v, vmax);
+        vnan = _mm_sub_epi64(vnan, _mm_castpd_si128(_mm_cmpunord_pd(v, v)));
+    }
+    double lanesMin[2], lanesMax[2], min, max;
+    long long lanesNan[2];
+    _mm_storeu_pd(lanesMin, vmin);
+    _mm_storeu_pd(lanesMax, vmax);
+    _mm_storeu_si128((__m128i *)lanesNan, vnan);
+    int nans = scalarDoublePrescan(arr + i, n - i, &min, &max);
+    for (int l = 0; l < 2; l++)
+    {
+        min = lanesMin[l] < min ? lanesMin[l] : min;
+        max = lanesMax[l] > max ? lanesMax[l] : max;
+        nans += (int)lanesNan[l];
+    }
+    *minOut = min;
+    *maxOut = max;
+    return nans;
+}
+
+SSE41_TARGET int sseFloatPrescan(const float arr[], int n, float *minOut, float *maxOut)
+{
+    __m128 vmin = _mm_set1_ps(INFINITY), vmax = _mm_set1_ps(-INFINITY);
+    __m128i vnan = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(arr + i);
+        vmin = _mm_min_ps(v, vmin);
+        vmax = _mm_max_ps(v, vmax);
+        vnan = _mm_sub_epi32(vnan, _mm_castps_si128(_mm_cmpunord_ps(v, v)));
+    }
+    float lanesMin[4], lanesMax[4], min, max;
+    int lanesNan[4];
+    _mm_storeu_ps(lanesMin, vmin);
+    _mm_storeu_ps(lanesMax, vmax);
+    _mm_storeu_si128((__m128i *)lanesNan, vnan);
+    int nans = scalarFloatPrescan(arr + i, n - i, &min, &max);
+    for (int l = 0; l < 4; l++)
+    {
+        min = lanesMin[l] < min ? lanesMin[l] : min;
+        max = lanesMax[l] > max ? lanesMax[l] : max;
+        nans += lanesNan[l];
+    }
+    *minOut = min;
+    *maxOut = max;
+    return nans;
+}
+#endif
+
+int doublePrescan(const double arr[], int n, double *minOut, double *maxOut)
+{
+#ifdef HAVE_X86_SIMD
+    int level = simdLevel();
+    if (level == SIMD_AVX2)
+        return avx2DoublePrescan(arr, n, minOut, maxOut);
+    if (level == SIMD_SSE41)
+        return sseDoublePrescan(arr, n, minOut, maxOut);
+#endif
+    return scalarDoublePrescan(arr, n, minOut, maxOut);
+}
+
+int floatPrescan(const float arr[], int n, float *minOut, float *maxOut)
+{
+#ifdef HAVE_X86_SIMD
+    int level = simdLevel();
+    if (level == SIMD_AVX2)
+        return avx2FloatPrescan(arr, n, minOut, maxOut);
+    if (level == SIMD_SSE41)
+        return sseFloatPrescan(arr, n, minOut, maxOut);
+#endif
+    return scalarFloatPrescan(arr, n, minOut, maxOut);
+}
+
+// Inverses of floatKey/doubleKey for keys of non-NaN values
+static inline float floatFromKey(uint32_t k)
+{
+    uint32_t u = k & 0x80000000u ? k ^ 0x80000000u : ~k;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static inline double doubleFromKey(uint64_t k)
+{
+    uint64_t u = k & 0x8000000000000000ull ? k ^ 0x8000000000000000ull : ~k;
+    double d;
+    memcpy(&d, &u, sizeof(d));
+    return d;
+}
+
+// DEFINE_FLOAT_SORT(name, T, KEY_NAME, KEY_T, KEY, FROM_KEY) adds, next to the generic sorts of
+// name (KEY_NAME names the generic sorts of KEY_T):
+//   nameRadixSortBetween(T arr[], int n, KEY_T low, KEY_T high): LSD radix of values whose keys
+//   lie in [low, high], over the bytes below the highest one where low and high differ
+//   nameSortTotal(T arr[], int n, int family): the total-order sort described above, with
+//   family one of SORT_FAMILY_RADIX, SORT_FAMILY_MERGE, SORT_FAMILY_INTRO
+#define DEFINE_FLOAT_SORT(name, T, KEY_NAME, KEY_T, KEY, FROM_KEY)                   \
+    void name##RadixSortBetween(T arr[], int n, KEY_T low, KEY_T high)               \
+    {                                                                                \
+        int passes = 0;                                                              \
+        for (KEY_T diff = low ^ high; diff != 0; diff >>= 8)                         \
+            passes++;                                                                \
+        if (n < 2 || passes == 0)                                                    \
+            return;                                                                  \
+        size_t count[sizeof(KEY_T)][256];                                            \
+        memset(count, 0, sizeof(count));                                             \
+        for (int i = 0; i < n; i++)                                                  \
+        {                                                                            \
+            KEY_T k = KEY(arr[i]);                                                   \
+            for (int p = 0; p < (int)sizeof(KEY_T); p++)                             \
+                if (p < passes)                                                      \
+                    count[p][(k >> (8 * p)) & 0xFF]++;                               \
+        }                                                                            \
+        T *buffer = (T *)malloc(n * sizeof(T));                                      \
+        T *src = arr, *dst = buffer;                                                 \
+        for (int p = 0; p < passes; p++)                                             \
+        {                                                                            \
+            int shift = 8 * p;                                                       \
+            if (count[p][(KEY(src[0]) >> shift) & 0xFF] == (size_t)n)                \
+                continue;                                                            \
+            size_t sum = 0;                                                          \
+            for (int b = 0; b < 256; b++)                                            \
+            {                                                                        \
+                size_t t = count[p][b];                                              \
+                count[p][b] = sum;                                                   \
+                sum += t;                                                            \
+            }                                                                        \
+            for (int i = 0; i < n; i++)                                              \
+                dst[count[p][(KEY(src[i]) >> shift) & 0xFF]++] = src[i];             \
+            T *t = src;                                                              \
+            src = dst;                                                               \
+            dst = t;                                                                 \
+        }                                                                            \
+        if (src != arr)                                                              \
+            memcpy(arr, src, n * sizeof(T));                                         \
+        free(buffer);                                                                \
+    }                                                                                \
+                                                                                     \
+    void name##SortTotal(T arr[], int n, int family)                                 \
+    {                                                                                \
+        if (n < 2)                                                                   \
+            return;                                                                  \
+        T min, max;                                                                  \
+        int nans = name##Prescan(arr, n, &min, &max);                                \
+        if (nans > 0)                                                                \
+        {                                                                            \
+            /* NaNs to the end, then ordered by payload */                           \
+            int hi = n;                                                              \
+            for (int i = 0; i < hi;)                                                 \
+            {                                                                        \
+                if (arr[i] != arr[i])                                                \
+                {                                                                    \
+                    T t = arr[i];                                                    \
+                    arr[i] = arr[--hi];                                              \
+                    arr[hi] = t;                                                     \
+                }                                                                    \
+                else                                                                 \
+                    i++;                                                             \
+            }                                                                        \
+            name##RadixSort(arr + hi, nans);                                         \
+            n = hi;                                                                  \
+            if (n < 2)                                                               \
+                return;                                                              \
+        }                                                                            \
+        /* min/max see -0.0 and +0.0 as equal, so widen a zero bound to both */      \
+        if (min == 0)                                                                \
+            min = -(T)0;                                                             \
+        if (max == 0)                                                                \
+            max = (T)0;                                                              \
+        if (family == SORT_FAMILY_RADIX)                                             \
+        {                                                                            \
+            name##RadixSortBetween(arr, n, KEY(min), KEY(max));                      \
+            return;                                                                  \
+        }                                                                            \
+        KEY_T *keys = (KEY_T *)malloc(n * sizeof(KEY_T));                            \
+        for (int i = 0; i < n; i++)                                                  \
+            keys[i] = KEY(arr[i]);                                                   \
+        if (family == SORT_FAMILY_MERGE)                                             \
+            KEY_NAME##MergeSort(keys, n);                                            \
+        else                                                                         \
+            KEY_NAME##IntroSort(keys, n);                                            \
+        for (int i = 0; i < n; i++)                                                  \
+            arr[i] = FROM_KEY(keys[i]);                                              \
+        free(keys);                                                                  \
+    }
+
+DEFINE_FLOAT_SORT(float, float, uint32, uint32_t, floatKey, floatFromKey)
+DEFINE_FLOAT_SORT(double, double, uint64, uint64_t, doubleKey, doubleFromKey)
+
+// Parallel Samplesort
+// In-place samplesort in the style of IPS4o. A sorted random sample, oversampled by about
+// 0.2 log2 n per bucket, gives SAMPLESORT_LEAVES - 1 splitters. They are stored as an implicit
+// search tree, so finding an element's bucket takes log2(leaves) branch-free steps. Elements
+// equal to a splitter go to an equality bucket of their own, which needs no further sorting.
+// Distribution happens in blocks of SAMPLESORT_BLOCK ints, inside the array:
+//  1. every thread classifies its stripe into one block-sized buffer per bucket and writes each
+//     full buffer back to the front of its stripe;
+//  2. full blocks are gathered at the front of the array, and every bucket gets a region of
+//     blocks with a write pointer (first slot) and a read pointer (last unprocessed block);
+//  3. threads pop blocks from the read end of a bucket and store them at the write pointer of
+//     the bucket they belong to, swapping out the unprocessed block they find there, until a
+//     block lands in an empty slot;
+//  4. the partial blocks at the bucket edges are filled from the thread buffers.
+// Threads then take buckets off a shared counter and sort each one sequentially: the same
+// distribution with one thread, down to SAMPLESORT_MIN, then pdqSort.
+#define SAMPLESORT_LOG_LEAVES 7
+#define SAMPLESORT_LEAVES (1 << SAMPLESORT_LOG_LEAVES)
+#define SAMPLESORT_BUCKETS (2 * SAMPLESORT_LEAVES)
+#define SAMPLESORT_BLOCK 256 // ints per block, 1 KiB
+#define SAMPLESORT_MIN (1 << 15)
+
+typedef struct
+{
+    int tree[SAMPLESORT_LEAVES];     // tree[1..LEAVES-1]; the children of node b are 2b and 2b+1
+    int splitter[SAMPLESORT_LEAVES]; // ascending; the last entry repeats the largest splitter
+} SampleClassifier;
+
+// Per-thread state, reused by every level that thread sorts
+typedef struct
+{
+    int *buffer; // one block per bucket
+    int *swap[2];
+    int fill[SAMPLESORT_BUCKETS];
+    long long count[SAMPLESORT_BUCKETS];
+} SampleLocal;
+
+typedef struct
+{
+    int *arr;
+    int n, threads, blocks; // blocks: whole blocks in arr; the partial tail only goes through buffers
+    SampleClassifier cls;
+    SampleLocal *local;
+    int *stripeStart; // first block of each stripe, threads + 1 entries
+    int *stripeFull;  // end of each stripe's full blocks after classification
+    long long bucketStart[SAMPLESORT_BUCKETS + 1];
+    int region[SAMPLESORT_BUCKETS + 1]; // first block of each bucket's region
+    int write[SAMPLESORT_BUCKETS];
+    int read[SAMPLESORT_BUCKETS];
+    pthread_mutex_t lock[SAMPLESORT_BUCKETS];
+    int *overflow; // a full block of the bucket that holds the array tail when its region is full
+    int overflowBucket;
+    int *extra; // cleanup scratch: (threads + 2) blocks
+    int nextBucket;
+    pthread_mutex_t nextLock;
+    pthread_barrier_t barrier;
+} SampleShared;
+
+// In-order layout: node gets the middle splitter of [lo, hi)
+void sampleTreeBuild(SampleClassifier *c, int node, int lo, int hi)
+{
+    if (lo >= hi)
+        return;
+    int mid = lo + (hi - lo) / 2;
+    c->tree[node] = c->splitter[mid];
+    sampleTreeBuild(c, 2 * node, lo, mid);
+    sampleTreeBuild(c, 2 * node + 1, mid + 1, hi);
+}
+
+// Returns 0 when every sampled element is equal; arr is not modified
+int sampleClassifierBuild(SampleClassifier *c, const int arr[], int n)
+{
+    int log2n = 0;
+    while ((1LL << log2n) < n)
+        log2n++;
+    int oversampling = log2n / 5 > 1 ? log2n / 5 : 1;
+    int samples = oversampling * SAMPLESORT_LEAVES;
+    int *sample = (int *)malloc(samples * sizeof(int));
+    for (int i = 0; i < samples; i++)
+        sample[i] = arr[randomU64() % (uint64_t)n];
+    pdqSort(sample, samples);
+
+    int distinct = sample[0] != sample[samples - 1];
+    if (distinct)
+    {
+        for (int i = 0; i < SAMPLESORT_LEAVES - 1; i++)
+            c->splitter[i] = sample[(i + 1) * oversampling - 1];
+        c->splitter[SAMPLESORT_LEAVES - 1] = c->splitter[SAMPLESORT_LEAVES - 2];
+        sampleTreeBuild(c, 1, 0, SAMPLESORT_LEAVES - 1);
+    }
+    free(sample);
+    return distinct;
+}
+
+// Leaf j holds (splitter[j-1], splitter[j]]; bucket 2j + 1 takes the elements equal to splitter[j]
+static inline int sampleBucket(const SampleClassifier *c, int x)
+{
+    int b = 1;
+    for (int l = 0; l < SAMPLESORT_LOG_LEAVES; l++)
+        b = 2 * b + (x > c->tree[b]);
+    b -= SAMPLESORT_LEAVES;
+    return 2 * b + (x == c->splitter[b]);
+}
+
+static inline void samplePush(SampleLocal *loc, int arr[], long long *write, int bucket, int x)
+{
+    int *buffer = loc->buffer + bucket * SAMPLESORT_BLOCK;
+    buffer[loc->fill[bucket]++] = x;
+    if (loc->fill[bucket] == SAMPLESORT_BLOCK)
+    {
+        memcpy(arr + *write, buffer, SAMPLESORT_BLOCK * sizeof(int));
+        *write += SAMPLESORT_BLOCK;
+        loc->fill[bucket] = 0;
+        loc->count[bucket] += SAMPLESORT_BLOCK;
+    }
+}
+
+// Step 1. Blocks are only written over elements that were already read, and four elements are
+// walked down the tree together so their loads overlap.
+void sampleClassifyStripe(SampleShared *sh, int t)
+{
+    const SampleClassifier *c = &sh->cls;
+    SampleLocal *loc = &sh->local[t];
+    int *arr = sh->arr;
+    long long begin = (long long)sh->stripeStart[t] * SAMPLESORT_BLOCK;
+    long long end = t == sh->threads - 1 ? sh->n : (long long)sh->stripeStart[t + 1] * SAMPLESORT_BLOCK;
+    long long write = begin, i = begin;
+    memset(loc->fill, 0, sizeof(loc->fill));
+    memset(loc->count, 0, sizeof(loc->count));
+
+    for (; i + 4 <= end; i += 4)
+    {
+        int x0 = arr[i], x1 = arr[i + 1], x2 = arr[i + 2], x3 = arr[i + 3];
+        int b0 = 1, b1 = 1, b2 = 1, b3 = 1;
+        for (int l = 0; l < SAMPLESORT_LOG_LEAVES; l++)
+        {
+            b0 = 2 * b0 + (x0 > c->tree[b0]);
+            b1 = 2 * b1 + (x1 > c->tree[b1]);
+            b2 = 2 * b2 + (x2 > c->tree[b2]);
+            b3 = 2 * b3 + (x3 > c->tree[b3]);
+        }
+        b0 -= SAMPLESORT_LEAVES;
+        b1 -= SAMPLESORT_LEAVES;
+        b2 -= SAMPLESORT_LEAVES;
+        b3 -= SAMPLESORT_LEAVES;
+        samplePush(loc, arr, &write, 2 * b0 + (x0 == c->splitter[b0]), x0);
+        samplePush(loc, arr, &write, 2 * b1 + (x1 == c->splitter[b1]), x1);
+        samplePush(loc, arr, &write, 2 * b2 + (x2 == c->splitter[b2]), x2);
+        samplePush(loc, arr, &write, 2 * b3 + (x3 == c->splitter[b3]), x3);
+    }
+    for (; i < end; i++)
+        samplePush(loc, arr, &write, sampleBucket(c, arr[i]), arr[i]);
+
+    for (int b = 0; b < SAMPLESORT_BUCKETS; b++)
+        loc->count[b] += loc->fill[b];
+    sh->stripeFull[t] = (int)(write / SAMPLESORT_BLOCK);
+}
+
+// Step 2 (one thread). A bucket's region starts at the first block boundary inside the bucket,
+// so it has room for all of the bucket's full blocks except when the bucket holds the array tail;
+// that bucket may be one block short, and that block goes to sh->overflow.
+void sampleDistributePrepare(SampleShared *sh)
+{
+    const size_t blockBytes = SAMPLESORT_BLOCK * sizeof(int);
+    long long sum = 0;
+    for (int b = 0; b < SAMPLESORT_BUCKETS; b++)
+    {
+        sh->bucketStart[b] = sum;
+        for (int t = 0; t < sh->threads; t++)
+            sum += sh->local[t].count[b];
+    }
+    sh->bucketStart[SAMPLESORT_BUCKETS] = sum;
+    for (int b = 0; b <= SAMPLESORT_BUCKETS; b++)
+    {
+        long long first = (sh->bucketStart[b] + SAMPLESORT_BLOCK - 1) / SAMPLESORT_BLOCK;
+        sh->region[b] = first < sh->blocks ? (int)first : sh->blocks;
+    }
+
+    // Fill the empty slots below `full` with the full blocks above it
+    int full = 0;
+    char *isFull = (char *)calloc(sh->blocks + 1, 1);
+    for (int t = 0; t < sh->threads; t++)
+    {
+        full += sh->stripeFull[t] - sh->stripeStart[t];
+        memset(isFull + sh->stripeStart[t], 1, sh->stripeFull[t] - sh->stripeStart[t]);
+    }
+    int hole = 0, src = sh->blocks - 1;
+    for (;;)
+    {
+        while (hole < full && isFull[hole])
+            hole++;
+        while (src >= full && !isFull[src])
+            src--;
+        if (hole >= full)
+            break;
+        memcpy(sh->arr + (long long)hole++ * SAMPLESORT_BLOCK, sh->arr + (long long)src-- * SAMPLESORT_BLOCK,
+               blockBytes);
+    }
+    free(isFull);
+
+    for (int b = 0; b < SAMPLESORT_BUCKETS; b++)
+    {
+        sh->write[b] = sh->region[b];
+        sh->read[b] = (sh->region[b + 1] < full ? sh->region[b + 1] : full) - 1;
+    }
+    sh->overflowBucket = -1;
+}
+
+// Step 3. Each thread starts at a different bucket. A slot at or below the read pointer still
+// holds an unprocessed block; above it the slot is free. Both pointers of a bucket, and the copies
+// in and out of its slots, are covered by that bucket's lock.
+void samplePermute(SampleShared *sh, int t)
+{
+    const size_t blockBytes = SAMPLESORT_BLOCK * sizeof(int);
+    SampleLocal *loc = &sh->local[t];
+    int *cur = loc->swap[0], *other = loc->swap[1];
+
+    for (int step = 0; step < SAMPLESORT_BUCKETS; step++)
+    {
+        int b = (int)(((long long)t * SAMPLESORT_BUCKETS / sh->threads + step) % SAMPLESORT_BUCKETS);
+        for (;;)
+        {
+            pthread_mutex_lock(&sh->lock[b]);
+            if (sh->read[b] < sh->write[b])
+            {
+                pthread_mutex_unlock(&sh->lock[b]);
+                break;
+            }
+            memcpy(cur, sh->arr + (long long)sh->read[b]-- * SAMPLESORT_BLOCK, blockBytes);
+            pthread_mutex_unlock(&sh->lock[b]);
+
+            for (;;)
+            {
+                int dest = sampleBucket(&sh->cls, cur[0]);
+                pthread_mutex_lock(&sh->lock[dest]);
+                // Unprocessed blocks that already belong here stay where they are
+                while (sh->write[dest] <= sh->read[dest] &&
+                       sampleBucket(&sh->cls, sh->arr[(long long)sh->write[dest] * SAMPLESORT_BLOCK]) == dest)
+                    sh->write[dest]++;
+
+                int w = sh->write[dest];
+                if (w == sh->region[dest + 1])
+                {
+                    memcpy(sh->overflow, cur, blockBytes);
+                    sh->overflowBucket = dest;
+                    pthread_mutex_unlock(&sh->lock[dest]);
+                    break;
+                }
+                sh->write[dest]++;
+                int *slot = sh->arr + (long long)w * SAMPLESORT_BLOCK;
+                if (w <= sh->read[dest])
+                {
+                    memcpy(other, slot, blockBytes);
+                    memcpy(slot, cur, blockBytes);
+                    pthread_mutex_unlock(&sh->lock[dest]);
+                    int *temp = cur;
+                    cur = other;
+                    other = temp;
+                    continue;
+                }
+                memcpy(slot, cur, blockBytes);
+                pthread_mutex_unlock(&sh->lock[dest]);
+                break;
+            }
+        }
+    }
+}
+
+// Step 4 (one thread, buckets in order). Full blocks sit in [region, write) of each bucket. The
+// last one may reach past the bucket's end into the next bucket's head; that excess is saved
+// before anything is written, and together with the overflow block and the thread buffers it
+// fills the head [start, region) and the tail [write, end) of the bucket.
+void sampleCleanup(SampleShared *sh)
+{
+    for (int b = 0; b < SAMPLESORT_BUCKETS; b++)
+    {
+        long long start = sh->bucketStart[b], end = sh->bucketStart[b + 1];
+        long long fullStart = (long long)sh->region[b] * SAMPLESORT_BLOCK;
+        long long fullEnd = (long long)sh->write[b] * SAMPLESORT_BLOCK;
+        int count = 0;
+
+        if (fullEnd > fullStart && fullEnd > end)
+        {
+            count = (int)(fullEnd - end);
+            memcpy(sh->extra, sh->arr + end, count * sizeof(int));
+        }
+        if (sh->overflowBucket == b)
+        {
+            memcpy(sh->extra + count, sh->overflow, SAMPLESORT_BLOCK * sizeof(int));
+            count += SAMPLESORT_BLOCK;
+        }
+        for (int t = 0; t < sh->threads; t++)
+        {
+            SampleLocal *loc = &sh->local[t];
+            memcpy(sh->extra + count, loc->buffer + b * SAMPLESORT_BLOCK, loc->fill[b] * sizeof(int));
+            count += loc->fill[b];
+        }
+
+        // Buckets past the last whole block have no region: fullStart is then below start
+        long long headEnd = fullStart < end ? fullStart : end;
+        if (headEnd < start)
+            headEnd = start;
+        int head = (int)(headEnd - start);
+        memcpy(sh->arr + start, sh->extra, head * sizeof(int));
+        memcpy(sh->arr + (fullEnd > headEnd ? fullEnd : headEnd), sh->extra + head, (count - head) * sizeof(int));
+    }
+}
+
+void sampleLocalInit(SampleLocal *loc)
+{
+    loc->buffer = (int *)malloc(SAMPLESORT_BUCKETS * SAMPLESORT_BLOCK * sizeof(int));
+    loc->swap[0] = (int *)malloc(2 * SAMPLESORT_BLOCK * sizeof(int));
+    loc->swap[1] = loc->swap[0] + SAMPLESORT_BLOCK;
+}
+
+void sampleLocalFree(SampleLocal *loc)
+{
+    free(loc->buffer);
+    free(loc->swap[0]);
+}
+
+// Returns NULL when the sample holds a single value (the caller falls back to pdqSort)
+SampleShared *sampleSharedCreate(int arr[], int n, int threads, SampleLocal *local)
+{
+    SampleShared *sh = (SampleShared *)malloc(sizeof(SampleShared));
+    if (!sampleClassifierBuild(&sh->cls, arr, n))
+    {
+        free(sh);
+        return NULL;
+    }
+    sh->arr = arr;
+    sh->n = n;
+    sh->threads = threads;
+    sh->blocks = n / SAMPLESORT_BLOCK;
+    sh->local = local;
+    sh->stripeStart = (int *)malloc((threads + 1) * sizeof(int));
+    sh->stripeFull = (int *)malloc(threads * sizeof(int));
+    for (int t = 0; t <= threads; t++)
+        sh->stripeStart[t] = (int)((long long)sh->blocks * t / threads);
+    for (int b = 0; b < SAMPLESORT_BUCKETS; b++)
+        pthread_mutex_init(&sh->lock[b], NULL);
+    sh->overflow = (int *)malloc((threads + 3) * SAMPLESORT_BLOCK * sizeof(int));
+    sh->extra = sh->overflow + SAMPLESORT_BLOCK;
+    sh->nextBucket = 0;
+    pthread_mutex_init(&sh->nextLock, NULL);
+    if (threads > 1)
+        pthread_barrier_init(&sh->barrier, NULL, threads);
+    return sh;
+}
+
+void sampleSharedFree(SampleShared *sh)
+{
+    if (sh->threads > 1)
+        pthread_barrier_destroy(&sh->barrier);
+    for (int b = 0; b < SAMPLESORT_BUCKETS; b++)
+        pthread_mutex_destroy(&sh->lock[b]);
+    pthread_mutex_destroy(&sh->nextLock);
+    free(sh->overflow);
+    free(sh->stripeStart);
+    free(sh->stripeFull);
+    free(sh);
+}
+
+void sampleSortSequential(int arr[], int n, SampleLocal *loc)
+{
+    if (n < SAMPLESORT_MIN)
+    {
+        pdqSort(arr, n);
+        return;
+    }
+    SampleShared *sh = sampleSharedCreate(arr, n, 1, loc);
+    if (!sh)
+    {
+        pdqSort(arr, n);
+        return;
+    }
+    sampleClassifyStripe(sh, 0);
+    sampleDistributePrepare(sh);
+    samplePermute(sh, 0);
+    sampleCleanup(sh);
+
+    long long bucketStart[SAMPLESORT_BUCKETS + 1];
+    memcpy(bucketStart, sh->bucketStart, sizeof(bucketStart));
+    sampleSharedFree(sh);
+
+    // Odd buckets hold copies of one splitter
+    for (int b = 0; b < SAMPLESORT_BUCKETS; b += 2)
+    {
+        int size = (int)(bucketStart[b + 1] - bucketStart[b]);
+        if (size == n)
+            pdqSort(arr, n); // the sample missed everything but one bucket
+        else if (size > 1)
+            sampleSortSequential(arr + bucketStart[b], size, loc);
+    }
+}
+
+typedef struct
+{
+    SampleShared *shared;
+    int id;
+} SampleWorker;
+
+void *sampleSortWorker(void *arg)
+{
+    SampleWorker *w = (SampleWorker *)arg;
+    SampleShared *sh = w->shared;
+    int t = w->id;
+
+    sampleClassifyStripe(sh, t);
+    pthread_barrier_wait(&sh->barrier);
+    if (t == 0)
+        sampleDistributePrepare(sh);
+    pthread_barrier_wait(&sh->barrier);
+    samplePermute(sh, t);
+    pthread_barrier_wait(&sh->barrier);
+    if (t == 0)
+        sampleCleanup(sh);
+    pthread_barrier_wait(&sh->barrier);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&sh->nextLock);
+        int b = sh->nextBucket;
+        sh->nextBucket += 2;
+        pthread_mutex_unlock(&sh->nextLock);
+        if (b >= SAMPLESORT_BUCKETS)
+            break;
+
+        long long start = sh->bucketStart[b];
+        int size = (int)(sh->bucketStart[b + 1] - start);
+        if (size == sh->n)
+            pdqSort(sh->arr, size);
+        else if (size > 1)
+            sampleSortSequential(sh->arr + start, size, &sh->local[t]);
+    }
+    return NULL;
+}
+
+void parallelSampleSort(int arr[], int n, int threads)
+{
+    // Sorted and reversed inputs are caught up front; distributing them gains nothing
+    int ascending = 1, descending = 1;
+    for (int i = 1; i < n && (ascending || descending); i++)
+    {
+        ascending &= arr[i - 1] <= arr[i];
+        descending &= arr[i - 1] >= arr[i];
+    }
+    if (ascending)
+        return;
+    if (descending)
+    {
+        intReverse(arr, n);
+        return;
+    }
+
+    // Every stripe should be worth a few blocks per bucket
+    if (threads > n / SAMPLESORT_MIN)
+        threads = n / SAMPLESORT_MIN;
+    if (threads < 1)
+        threads = 1;
+
+    SampleLocal *local = (SampleLocal *)malloc(threads * sizeof(SampleLocal));
+    for (int t = 0; t < threads; t++)
+        sampleLocalInit(&local[t]);
+
+    SampleShared *sh = threads > 1 ? sampleSharedCreate(arr, n, threads, local) : NULL;
+    if (sh)
+    {
+        pthread_t *ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+        SampleWorker *workers = (SampleWorker *)malloc(threads * sizeof(SampleWorker));
+        for (int t = 0; t < threads; t++)
+        {
+            workers[t].shared = sh;
+            workers[t].id = t;
+            pthread_create(&ids[t], NULL, sampleSortWorker, &workers[t]);
+        }
+        for (int t = 0; t < threads; t++)
+            pthread_join(ids[t], NULL);
+        free(workers);
+        free(ids);
+        sampleSharedFree(sh);
+    }
+    else
+        sampleSortSequential(arr, n, &local[0]);
+
+    for (int t = 0; t < threads; t++)
+        sampleLocalFree(&local[t]);
+    free(local);
+}
+
+// Below two stripes parallelSampleSort uses one thread; skip the sysconf call there
+void sampleSort(int arr[], int n) { parallelSampleSort(arr, n, n >= 2 * SAMPLESORT_MIN ? hardwareThreads() : 1); }
+
+// Parallel Merge Sort
+// Threads sort equal slices with intStableSort, then neighbouring runs are merged pairwise into
+// the other buffer, one thread per pair, halving the number of runs each round.
+#define PARALLEL_MERGE_MIN 65536
+
+typedef struct
+{
+    int *src, *dst; // dst == NULL: sort src[begin, end) in place
+    int begin, mid, end;
+} MergeJob;
+
+void *mergeJobWorker(void *arg)
+{
+    MergeJob *job = (MergeJob *)arg;
+    if (!job->dst)
+    {
+        intStableSort(job->src + job->begin, job->end - job->begin);
+        return NULL;
+    }
+    const int *src = job->src;
+    int *dst = job->dst;
+    int i = job->begin, j = job->mid, k = job->begin;
+    while (i < job->mid && j < job->end)
+        dst[k++] = src[j] < src[i] ? src[j++] : src[i++];
+    memcpy(dst + k, src + i, (job->mid - i) * sizeof(int));
+    k += job->mid - i;
+    memcpy(dst + k, src + j, (job->end - j) * sizeof(int));
+    return NULL;
+}
+
+void runMergeJobs(MergeJob jobs[], int count)
+{
+    pthread_t *ids = (pthread_t *)malloc(count * sizeof(pthread_t));
+    for (int i = 0; i < count; i++)
+        pthread_create(&ids[i], NULL, mergeJobWorker, &jobs[i]);
+    for (int i = 0; i < count; i++)
+        pthread_join(ids[i], NULL);
+    free(ids);
+}
+
+void parallelMergeSort(int arr[], int n, int threads)
+{
+    if (threads <= 1 || n < PARALLEL_MERGE_MIN)
+    {
+        intStableSort(arr, n);
+        return;
+    }
+
+    int *buffer = (int *)malloc(n * sizeof(int));
+    int *bounds = (int *)malloc((threads + 1) * sizeof(int));
+    MergeJob *jobs = (MergeJob *)malloc(threads * sizeof(MergeJob));
+    int runs = threads;
+    for (int t = 0; t <= threads; t++)
+        bounds[t] = (int)((long long)n * t / threads);
+    for (int t = 0; t < threads; t++)
+        jobs[t] = (MergeJob){arr, NULL, bounds[t], bounds[t], bounds[t + 1]};
+    runMergeJobs(jobs, threads);
+
+    int *src = arr, *dst = buffer;
+    while (runs > 1)
+    {
+        int pairs = runs / 2;
+        for (int p = 0; p < pairs; p++)
+            jobs[p] = (MergeJob){src, dst, bounds[2 * p], bounds[2 * p + 1], bounds[2 * p + 2]};
+        if (runs % 2)
+            memcpy(dst + bounds[runs - 1], src + bounds[runs - 1], (n - bounds[runs - 1]) * sizeof(int));
+        runMergeJobs(jobs, pairs);
+
+        for (int r = 0; r < (runs + 1) / 2; r++)
+            bounds[r] = bounds[2 * r];
+        runs = (runs + 1) / 2;
+        bounds[runs] = n;
+        int *temp = src;
+        src = dst;
+        dst = temp;
+    }
+    if (src != arr)
+        memcpy(arr, src, n * sizeof(int));
+
+    free(jobs);
+    free(bounds);
+    free(buffer);
+}
+
+// Multiway Merge Sort
+// A binary merge sort streams the whole array through memory once per level, log2(n / run)
+// times: about 27 passes over 400 MB for 10^8 ints. multiwayMergeSort first sorts runs of
+// MULTIWAY_RUN ints, small enough to stay in the L2 cache, with intStableSort. It then merges
+// up to fanIn runs per pass into the other buffer with a loser tree. fanIn is the smallest
+// value that still needs the fewest passes, so the passes are balanced. With MULTIWAY_FAN_IN
+// = 64, 10^8 ints take one run pass and two merge passes over DRAM. The bound keeps the k input
+// streams and the output within reach of the cache and TLB; the loser tree is only k words.
+// Ties go to the earlier run, so the sort is stable.
+#define MULTIWAY_RUN (1 << 15) // ints, 128 KB
+#define MULTIWAY_FAN_IN 64
+
+// Merge-pass loser tree entry: the key with its sign flipped above the run index, so one
+// unsigned compare orders by key and breaks ties towards the earlier run
+static inline uint64_t multiwayHead(int key, int run)
+{
+    return (uint64_t)((uint32_t)key ^ 0x80000000u) << 32 | (uint32_t)run;
+}
+
+// Merges consecutive groups of fanIn sorted runs of runLength from src into dst. Unlike the
+// LoserTree of the external sort, the tree here holds the losing heads themselves: a replay is
+// one compare per level with no indirection, and an exhausted run turns into UINT64_MAX
+// instead of a done flag. The group's length says when to stop.
+void multiwayMergePass(const int src[], int dst[], int n, int runLength, int fanIn)
+{
+    int leaves = 1;
+    while (leaves < fanIn)
+        leaves *= 2;
+    uint64_t *tree = (uint64_t *)malloc(leaves * sizeof(uint64_t));
+    uint64_t *winners = (uint64_t *)malloc(2 * leaves * sizeof(uint64_t));
+    int *pos = (int *)malloc(leaves * sizeof(int));
+    int *end = (int *)malloc(leaves * sizeof(int));
+    for (long long group = 0; group < n; group += (long long)runLength * fanIn)
+    {
+        long long groupEnd = group + (long long)runLength * fanIn < n ? group + (long long)runLength * fanIn : n;
+        if (groupEnd - group <= runLength)
+        {
+            memcpy(dst + group, src + group, (groupEnd - group) * sizeof(int));
+            continue;
+        }
+        for (int r = 0; r < leaves; r++)
+        {
+            long long lo = group + (long long)r * runLength;
+            pos[r] = end[r] = 0;
+            winners[leaves + r] = UINT64_MAX;
+            if (lo < groupEnd)
+            {
+                pos[r] = (int)lo;
+                end[r] = (int)(lo + runLength < groupEnd ? lo + runLength : groupEnd);
+                winners[leaves + r] = multiwayHead(src[lo], r);
+            }
+        }
+        // Play every match once: the loser stays in the node, the winner moves up
+        for (int node = leaves - 1; node > 0; node--)
+        {
+            uint64_t a = winners[2 * node], b = winners[2 * node + 1];
+            winners[node] = a < b ? a : b;
+            tree[node] = a < b ? b : a;
+        }
+
+        uint64_t winner = winners[1];
+        for (long long out = group; out < groupEnd; out++)
+        {
+            int r = (int)(uint32_t)winner;
+            dst[out] = (int)((uint32_t)(winner >> 32) ^ 0x80000000u);
+            uint64_t next = ++pos[r] < end[r] ? multiwayHead(src[pos[r]], r) : UINT64_MAX;
+            for (int node = (r + leaves) / 2; node > 0; node /= 2)
+            {
+                uint64_t t = tree[node];
+                tree[node] = t < next ? next : t;
+                next = t < next ? t : next;
+            }
+            winner = next;
+        }
+    }
+    free(end);
+    free(pos);
+    free(winners);
+    free(tree);
+}
+
+// Returns the number of merge passes; maxFanIn 2 gives a binary merge sort over the same runs
+int multiwayMergeSortFanIn(int arr[], int n, int maxFanIn)
+{
+    if (n <= MULTIWAY_RUN)
+    {
+        intStableSort(arr, n);
+        return 0;
+    }
+    for (int lo = 0; lo < n; lo += MULTIWAY_RUN)
+        intStableSort(arr + lo, n - lo < MULTIWAY_RUN ? n - lo : MULTIWAY_RUN);
+
+    int runs = (n + MULTIWAY_RUN - 1) / MULTIWAY_RUN, passes = 0, fanIn = 2;
+    for (long long covered = 1; covered < runs; covered *= maxFanIn)
+        passes++;
+    for (;; fanIn++)
+    {
+        long long covered = 1;
+        for (int p = 0; p < passes; p++)
+            covered *= fanIn;
+        if (covered >= runs)
+            break;
+    }
+
+    int *buffer = (int *)malloc(n * sizeof(int));
+    int *src = arr, *dst = buffer;
+    for (long long runLength = MULTIWAY_RUN; runLength < n; runLength *= fanIn)
+    {
+        multiwayMergePass(src, dst, n, (int)runLength, fanIn);
+        int *t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != arr)
+        memcpy(arr, src, n * sizeof(int));
+    free(buffer);
+    return passes;
+}
+
+void multiwayMergeSort(int arr[], int n)
+{
+    multiwayMergeSortFanIn(arr, n, MULTIWAY_FAN_IN);
+}
+
+// String Sorting
+// Strings live in one contiguous arena and are sorted as StringRef (offset, length) pairs, so
+// only 8-byte entries move. Bytes compare unsigned and a string sorts before its extensions
+// (the order of strcmp). stringChar() returns -1 past the end of a string.
+//  - multikeyQuicksort: Bentley-Sedgewick three-way partitioning on the character at the
+//    current depth; only the equal part moves on to the next character.
+//  - stringRadixSort: MSD radix sort (257 buckets per character) on cache-sized runs that also
+//    yields each run's LCP array. The runs are then merged pairwise by an LCP merge, which
+//    compares two heads only from the longer-known common prefix onwards.
+//  - burstSort: a burst trie of small buckets. A bucket that grows past BURST_LIMIT is burst
+//    into a trie node one character deeper. Buckets are sorted with multikeyQuicksort on
+//    an in-order walk.
+#define STRING_INSERTION 16     // multikey quicksort and radix buckets below this: insertion sort
+#define STRING_RUN (1 << 14)    // strings per radix-sorted run before LCP merging
+#define BURST_LIMIT 8192        // strings per burst trie bucket before it bursts
+
+typedef struct
+{
+    uint32_t offset;
+    uint32_t length;
+} StringRef;
+
+static inline int stringChar(const char *arena, StringRef s, uint32_t depth)
+{
+    return depth < s.length ? (unsigned char)arena[s.offset + depth] : -1;
+}
+
+// Compares a and b from depth on (their first depth bytes must be equal); lcp, when not NULL,
+// receives the length of their common prefix
+static inline int stringCompare(const char *arena, StringRef a, StringRef b, uint32_t depth, uint32_t *lcp)
+{
+    const unsigned char *pa = (const unsigned char *)arena + a.offset;
+    const unsigned char *pb = (const unsigned char *)arena + b.offset;
+    uint32_t limit = a.length < b.length ? a.length : b.length, i = depth;
+    while (i < limit && pa[i] == pb[i])
+        i++;
+    if (lcp)
+        *lcp = i;
+    if (i < limit)
+        return pa[i] - pb[i];
+    return (a.length > b.length) - (a.length < b.length);
+}
+
+void stringInsertionSort(const char *arena, StringRef refs[], int n, uint32_t depth)
+{
+    for (int i = 1; i < n; i++)
+    {
+        StringRef key = refs[i];
+        int j = i - 1;
+        while (j >= 0 && stringCompare(arena, refs[j], key, depth, NULL) > 0)
+        {
+            refs[j + 1] = refs[j];
+            j--;
+        }
+        refs[j + 1] = key;
+    }
+}
+
+// Multikey Quicksort
+void multikeyQuicksortDepth(const char *arena, StringRef refs[], int n, uint32_t depth)
+{
+    while (n > STRING_INSERTION)
+    {
+        int a = stringChar(arena, refs[0], depth);
+        int b = stringChar(arena, refs[n / 2], depth);
+        int c = stringChar(arena, refs[n - 1], depth);
+        int pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+
+        // [0, lt) below the pivot, [lt, i) equal, (gt, n) above
+        int lt = 0, i = 0, gt = n - 1;
+        while (i <= gt)
+        {
+            int ch = stringChar(arena, refs[i], depth);
+            StringRef temp = refs[i];
+            if (ch < pivot)
+            {
+                refs[i++] = refs[lt];
+                refs[lt++] = temp;
+            }
+            else if (ch > pivot)
+            {
+                refs[i] = refs[gt];
+                refs[gt--] = temp;
+            }
+            else
+                i++;
+        }
+        multikeyQuicksortDepth(arena, refs, lt, depth);
+        multikeyQuicksortDepth(arena, refs + gt + 1, n - gt - 1, depth);
+        if (pivot < 0)
+            return; // the equal strings all end here
+        refs += lt;
+        n = gt + 1 - lt;
+        depth++;
+    }
+    stringInsertionSort(arena, refs, n, depth);
+}
+
+void multikeyQuicksort(const char *arena, StringRef refs[], int n) { multikeyQuicksortDepth(arena, refs, n, 0); }
+
+// MSD String Radix Sort with LCP Merging
+// Sorts refs (all sharing their first depth bytes) and sets lcp[1..n-1], where lcp[i] is the
+// common prefix length of refs[i - 1] and refs[i]
+void stringRadixSortDepth(const char *arena, StringRef refs[], StringRef temp[], uint32_t lcp[], int n, uint32_t depth)
+{
+    if (n < STRING_INSERTION)
+    {
+        stringInsertionSort(arena, refs, n, depth);
+        for (int i = 1; i < n; i++)
+            stringCompare(arena, refs[i - 1], refs[i], depth, &lcp[i]);
+        return;
+    }
+
+    int count[257];
+    for (;;)
+    {
+        memset(count, 0, sizeof(count));
+        for (int i = 0; i < n; i++)
+            count[stringChar(arena, refs[i], depth) + 1]++;
+        // A common character only deepens the prefix
+        if (count[0] == n || (count[0] == 0 && count[stringChar(arena, refs[0], depth) + 1] == n))
+        {
+            if (count[0] == n)
+            {
+                for (int i = 1; i < n; i++)
+                    lcp[i] = depth;
+                return;
+            }
+            depth++;
+            continue;
+        }
+        break;
+    }
+
+    int pos[257], sum = 0;
+    for (int c = 0; c < 257; c++)
+    {
+        pos[c] = sum;
+        sum += count[c];
+    }
+    for (int i = 0; i < n; i++)
+        temp[pos[stringChar(arena, refs[i], depth) + 1]++] = refs[i];
+    memcpy(refs, temp, n * sizeof(StringRef));
+
+    int start = 0;
+    for (int c = 0; c < 257; c++)
+    {
+        int size = count[c];
+        if (size == 0)
+            continue;
+        if (start > 0)
+            lcp[start] = depth;
+        if (c == 0)
+        {
+            for (int i = 1; i < size; i++)
+                lcp[start + i] = depth;
+        }
+        else if (size > 1)
+            stringRadixSortDepth(arena, refs + start, temp + start, lcp + start, size, depth + 1);
+        start += size;
+    }
+}
+
+// Merges sorted a and b, with their LCP arrays, into out and outLcp. ha and hb are the common
+// prefix lengths of each head with the last string output. When they differ, the head with
+// the longer one is smaller; only when they are equal are the heads compared, from that length on.
+void stringLcpMerge(const char *arena, const StringRef a[], const uint32_t lcpA[], int na, const StringRef b[],
+                    const uint32_t lcpB[], int nb, StringRef out[], uint32_t outLcp[])
+{
+    int i = 0, j = 0, k = 0;
+    uint32_t ha = 0, hb = 0;
+    while (i < na && j < nb)
+    {
+        int takeA;
+        if (ha != hb)
+            takeA = ha > hb;
+        else
+        {
+            uint32_t h;
+            takeA = stringCompare(arena, a[i], b[j], ha, &h) <= 0;
+            if (takeA)
+                hb = h;
+            else
+                ha = h;
+        }
+        if (takeA)
+        {
+            outLcp[k] = ha;
+            out[k++] = a[i++];
+            ha = i < na ? lcpA[i] : 0;
+        }
+        else
+        {
+            outLcp[k] = hb;
+            out[k++] = b[j++];
+            hb = j < nb ? lcpB[j] : 0;
+        }
+    }
+    for (; i < na; i++, k++)
+    {
+        outLcp[k] = ha;
+        out[k] = a[i];
+        ha = i + 1 < na ? lcpA[i + 1] : 0;
+    }
+    for (; j < nb; j++, k++)
+    {
+        outLcp[k] = hb;
+        out[k] = b[j];
+        hb = j + 1 < nb ? lcpB[j + 1] : 0;
+    }
+}
+
+// lcp (may be NULL) receives the LCP array of the sorted output, lcp[0] = 0
+void stringRadixSortLcp(const char *arena, StringRef refs[], int n, uint32_t lcp[])
+{
+    if (n <= 0)
+        return;
+    StringRef *temp = (StringRef *)malloc(n * sizeof(StringRef));
+    uint32_t *lcpBuffer = (uint32_t *)malloc(2 * n * sizeof(uint32_t));
+    uint32_t *curLcp = lcpBuffer, *nextLcp = lcpBuffer + n;
+
+    for (int start = 0; start < n; start += STRING_RUN)
+    {
+        int size = n - start < STRING_RUN ? n - start : STRING_RUN;
+        stringRadixSortDepth(arena, refs + start, temp + start, curLcp + start, size, 0);
+        curLcp[start] = 0;
+    }
+
+    StringRef *src = refs, *dst = temp;
+    for (int width = STRING_RUN; width < n; width *= 2)
+    {
+        for (int start = 0; start < n; start += 2 * width)
+        {
+            int mid = start + width < n ? start + width : n;
+            int end = start + 2 * width < n ? start + 2 * width : n;
+            stringLcpMerge(arena, src + start, curLcp + start, mid - start, src + mid, curLcp + mid, end - mid,
+                           dst + start, nextLcp + start);
+        }
+        StringRef *swapRefs = src;
+        src = dst;
+        dst = swapRefs;
+        uint32_t *swapLcp = curLcp;
+        curLcp = nextLcp;
+        nextLcp = swapLcp;
+    }
+    if (src != refs)
+        memcpy(refs, src, n * sizeof(StringRef));
+    if (lcp)
+    {
+        memcpy(lcp, curLcp, n * sizeof(uint32_t));
+        lcp[0] = 0;
+    }
+
+    free(lcpBuffer);
+    free(temp);
+}
+
+void stringRadixSort(const char *arena, StringRef refs[], int n) { stringRadixSortLcp(arena, refs, n, NULL); }
+
+// Burstsort
+// Slot c of a node at depth d holds the strings whose character d is c - 1; slot 0 holds the
+// ones that end at d, which are all equal and never burst.
+typedef struct
+{
+    StringRef *refs;
+    int size, capacity;
+} BurstBucket;
+
+typedef struct BurstNode
+{
+    struct BurstNode *child[257];
+    BurstBucket bucket[257];
+} BurstNode;
+
+void burstBucketPush(BurstBucket *b, StringRef s)
+{
+    if (b->size == b->capacity)
+    {
+        b->capacity = b->capacity ? 2 * b->capacity : 16;
+        b->refs = (StringRef *)realloc(b->refs, b->capacity * sizeof(StringRef));
+    }
+    b->refs[b->size++] = s;
+}
+
+void burstInsert(BurstNode *root, const char *arena, StringRef s)
+{
+    BurstNode *node = root;
+    uint32_t depth = 0;
+    int c = stringChar(arena, s, depth) + 1;
+    while (node->child[c])
+    {
+        node = node->child[c];
+        c = stringChar(arena, s, ++depth) + 1;
+    }
+    BurstBucket *b = &node->bucket[c];
+    burstBucketPush(b, s);
+    if (c == 0 || b->size <= BURST_LIMIT)
+        return;
+
+    BurstNode *child = (BurstNode *)calloc(1, sizeof(BurstNode));
+    for (int i = 0; i < b->size; i++)
+        burstBucketPush(&child->bucket[stringChar(arena, b->refs[i], depth + 1) + 1], b->refs[i]);
+    free(b->refs);
+    b->refs = NULL;
+    b->size = b->capacity = 0;
+    node->child[c] = child;
+}
+
+// In-order walk: writes the strings below node to out, returns how many
+int burstCollect(BurstNode *node, const char *arena, uint32_t depth, StringRef out[])
+{
+    int written = 0;
+    for (int c = 0; c < 257; c++)
+    {
+        if (node->child[c])
+        {
+            written += burstCollect(node->child[c], arena, depth + 1, out + written);
+            free(node->child[c]);
+            continue;
+        }
+        BurstBucket *b = &node->bucket[c];
+        if (c > 0)
+            multikeyQuicksortDepth(arena, b->refs, b->size, depth + 1);
+        if (b->size > 0)
+            memcpy(out + written, b->refs, b->size * sizeof(StringRef));
+        written += b->size;
+        free(b->refs);
+    }
+    return written;
+}
+
+void burstSort(const char *arena, StringRef refs[], int n)
+{
+    BurstNode *root = (BurstNode *)calloc(1, sizeof(BurstNode));
+    for (int i = 0; i < n; i++)
+        burstInsert(root, arena, refs[i]);
+    burstCollect(root, arena, 0, refs);
+    free(root);
+}
+
+// Newline-delimited input
+typedef struct
+{
+    char *arena; // the lines, each followed by '\0'
+    size_t size;
+    StringRef *refs;
+    int count;
+    int mapped; // arena is a private file mapping rather than malloc'd
+} StringSet;
+
+// Maps the file copy-on-write and replaces every '\n' with '\0', so each line is also a C
+// string for strcmp. The byte after a file that does not end in '\n' is the zero fill of the
+// last page, unless the file fills that page exactly; then the file is copied instead.
+// Returns 0, or -1 on error.
+int loadStringFile(const char *path, StringSet *set)
+{
+    memset(set, 0, sizeof(*set));
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        printf("Error opening %s.\n", path);
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    set->size = (size_t)st.st_size;
+    if (set->size >= UINT32_MAX)
+    {
+        printf("Error: %s is too large for 32-bit string offsets.\n", path);
+        close(fd);
+        return -1;
+    }
+    if (set->size > 0)
+    {
+        char *map = (char *)mmap(NULL, set->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            printf("Error mapping %s.\n", path);
+            close(fd);
+            return -1;
+        }
+        if (map[set->size - 1] != '\n' && set->size % (size_t)sysconf(_SC_PAGESIZE) == 0)
+        {
+            set->arena = (char *)malloc(set->size + 1);
+            memcpy(set->arena, map, set->size);
+            set->arena[set->size] = '\0';
+            munmap(map, set->size);
+        }
+        else
+        {
+            set->arena = map;
+            set->mapped = 1;
+        }
+    }
+    close(fd);
+
+    int capacity = 1024;
+    set->refs = (StringRef *)malloc(capacity * sizeof(StringRef));
+    size_t start = 0;
+    for (size_t i = 0; i <= set->size; i++)
+    {
+        if (i < set->size && set->arena[i] != '\n')
+            continue;
+        if (i == set->size && i == start)
+            break; // no line after the final newline
+        if (set->count == capacity)
+        {
+            capacity *= 2;
+            set->refs = (StringRef *)realloc(set->refs, capacity * sizeof(StringRef));
+        }
+        set->refs[set->count++] = (StringRef){(uint32_t)start, (uint32_t)(i - start)};
+        if (i < set->size)
+            set->arena[i] = '\0';
+        start = i + 1;
+    }
+    return 0;
+}
+
+void freeStringSet(StringSet *set)
+{
+    if (set->mapped)
+        munmap(set->arena, set->size);
+    else
+        free(set->arena);
+    free(set->refs);
+}
+
+// Sort Algorithm Table
+void mergeSortRange(int arr[], int n)
+{
+    if (n > 1)
+        mergeSort(arr, 0, n - 1);
+}
+
+void quickSortRange(int arr[], int n) { quickSort(arr, 0, n - 1); }
+void inPlaceMergeSortRange(int arr[], int n) { inPlaceMergeSort(arr, 0, n - 1); }
+
+// stable: equal keys keep their input order (the int sorts cannot show it, but record versions
+// of the same algorithm would). Counting sort rewrites values instead of moving them.
+typedef struct
+{
+    const char *name;
+    void (*sort)(int[], int);
+    int stable;
+} SortAlgorithm;
+
+SortAlgorithm sortAlgorithms[] = {
+    {"Bubble Sort", bubbleSort, 1},
+    {"Selection Sort", selectionSort, 0},
+    {"Insertion Sort", insertionSort, 1},
+    {"Merge Sort", mergeSortRange, 1},
+    {"Quick Sort", quickSortRange, 0},
+    {"Heap Sort", heapSort, 0},
+    {"Bottom-Up Heap Sort", heapSortBottomUp, 0},
+    {"Radix Sort", radixSort, 1},
+    {"Shell Sort", shellSort, 0},
+    {"Intro Sort", introSort, 0},
+    {"PDQ Sort", pdqSort, 0},
+    {"Natural Merge Sort", naturalMergeSort, 1},
+    {"SIMD Sort", simdSort, 0},
+    {"Counting Sort", boundedCountingSort, 0},
+    {"Stable Merge Sort", intStableSort, 1},
+    {"In-Place Merge Sort", inPlaceMergeSortRange, 1},
+    {"Samplesort", sampleSort, 0},
+    {"Multiway Merge Sort", multiwayMergeSort, 1},
+};
+int numSortAlgorithms = sizeof(sortAlgorithms) / sizeof(sortAlgorithms[0]);
+
+// O(n^2) entries; benchmarks and the test suite keep their inputs small
+int isQuadraticSort(void (*sort)(int[], int))
+{
+    return sort == bubbleSort || sort == selectionSort || sort == insertionSort;
+}
+
+// Size limits shared by the benchmark drivers: quadratic sorts beyond QUADRATIC_MAX_N take too long,
+// and merge() keeps both halves in VLAs on the stack, so mergeSort stops at MERGE_SORT_MAX_N
+#define QUADRATIC_MAX_N 16000
+#define MERGE_SORT_MAX_N 1000000
+
+int tooLargeFor(void (*sort)(int[], int), long long n)
+{
+    return (isQuadraticSort(sort) && n > QUADRATIC_MAX_N) || (sort == mergeSortRange && n > MERGE_SORT_MAX_N);
+}
+
+// Entries that start threads; benchmarks must not pin them to one core
+int isParallelSort(void (*sort)(int[], int))
+{
+    return sort == sampleSort || sort == boundedCountingSort;
+}
+
+// Stability Check
+// Record versions of the algorithms are run on keys with many duplicates; each record's tag is
+// its input position, so a stable sort leaves tags increasing within every run of equal keys.
+typedef struct
+{
+    const char *name;
+    void (*sort)(TaggedRecord[], int);
+    int stable;
+} TaggedSortAlgorithm;
+
+void taggedArgsortRadix(TaggedRecord arr[], int n)
+{
+    sortRecordsByKey(arr, n, sizeof(TaggedRecord), offsetof(TaggedRecord, key), SORT_FAMILY_RADIX);
+}
+
+void taggedArgsortMerge(TaggedRecord arr[], int n)
+{
+    sortRecordsByKey(arr, n, sizeof(TaggedRecord), offsetof(TaggedRecord, key), SORT_FAMILY_MERGE);
+}
+
+void taggedArgsortIntro(TaggedRecord arr[], int n)
+{
+    sortRecordsByKey(arr, n, sizeof(TaggedRecord), offsetof(TaggedRecord, key), SORT_FAMILY_INTRO);
+}
+
+TaggedSortAlgorithm taggedSortAlgorithms[] = {
+    {"Insertion Sort", taggedInsertionSort, 1},
+    {"Merge Sort", taggedMergeSort, 1},
+    {"Heap Sort", taggedHeapSort, 0},
+    {"Intro Sort", taggedIntroSort, 0},
+    {"Radix Sort", taggedRadixSort, 1},
+    {"Stable Merge Sort", taggedStableSort, 1},
+    {"Argsort (radix)", taggedArgsortRadix, 1},
+    {"Argsort (merge)", taggedArgsortMerge, 1},
+    {"Argsort (intro)", taggedArgsortIntro, 0},
+};
+int numTaggedSortAlgorithms = sizeof(taggedSortAlgorithms) / sizeof(taggedSortAlgorithms[0]);
+
+// Returns 1 when equal keys kept their input order, 0 when some were reordered, and -1 when the
+// output is not a sorted permutation of the input
+int verifyStability(void (*sort)(TaggedRecord[], int), int n, int distinctKeys)
+{
+    TaggedRecord *arr = (TaggedRecord *)malloc(n * sizeof(TaggedRecord));
+    int *original = (int *)malloc(n * sizeof(int));
+    char *seen = (char *)calloc(n, 1);
+    for (int i = 0; i < n; i++)
+    {
+        arr[i].key = (int)(randomU64() % distinctKeys) - distinctKeys / 2;
+        arr[i].tag = i;
+        original[i] = arr[i].key;
+    }
+
+    sort(arr, n);
+
+    int result = 1;
+    for (int i = 0; i < n && result >= 0; i++)
+    {
+        int tag = arr[i].tag;
+        if (tag < 0 || tag >= n || seen[tag] || original[tag] != arr[i].key)
+            result = -1;
+        else if (i > 0 && arr[i - 1].key > arr[i].key)
+            result = -1;
+        else
+        {
+            seen[tag] = 1;
+            if (i > 0 && arr[i - 1].key == arr[i].key && arr[i - 1].tag > tag)
+                result = 0;
+        }
+    }
+
+    free(arr);
+    free(original);
+    free(seen);
+    return result;
+}
+
+// Runs one sort in a forked child so its peak resident memory can be read back with wait4();
+// the copy being sorted is part of that peak, so callers subtract a run with sort == NULL
+int measureSortInChild(void (*sort)(int[], int), const int src[], int n, double *seconds, long *peakKB)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return -1;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0)
+    {
+        close(fds[0]);
+        int *arr = (int *)malloc(n * sizeof(int));
+        memcpy(arr, src, n * sizeof(int));
+        double start = wallTime();
+        if (sort)
+            sort(arr, n);
+        double elapsed = wallTime() - start;
+        if (sort && !isSorted(arr, n))
+            elapsed = NAN;
+        if (write(fds[1], &elapsed, sizeof(elapsed)) != sizeof(elapsed))
+            _exit(1);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    int ok = read(fds[0], seconds, sizeof(*seconds)) == sizeof(*seconds);
+    close(fds[0]);
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0 || !ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return -1;
+    *peakKB = usage.ru_maxrss;
+    return 0;
+}
+
+// Input Distributions
+enum
+{
+    DIST_RANDOM,
+    DIST_SORTED,
+    DIST_REVERSED,
+    DIST_NEARLY_SORTED,
+    DIST_FEW_UNIQUE,
+    DIST_MOD1000,
+    DIST_NORMAL,
+    DIST_SAWTOOTH,
+    DIST_ORGAN_PIPE,
+    DIST_COUNT
+};
+
+const char *distributionNames[] = {"random", "sorted", "reversed", "nearly_sorted", "few_unique",
+                                   "mod1000", "normal", "sawtooth", "organ_pipe"};
+
+// Generate Normally Distributed Random Numbers (Box-Muller Transform)
+double generateNormalRandom(double mean, double stddev)
+{
+    double u1 = ((double)(randomU64() >> 11) + 1.0) / 9007199254740993.0;
+    double u2 = (double)(randomU64() >> 11) / 9007199254740992.0;
+    double z0 = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    return z0 * stddev + mean;
+}
+
+void fillDistribution(int arr[], int n, int dist)
+{
+    for (int i = 0; i < n; i++)
+    {
+        switch (dist)
+        {
+        case DIST_RANDOM: arr[i] = (int)(uint32_t)randomU64(); break;
+        case DIST_SORTED:
+        case DIST_NEARLY_SORTED: arr[i] = i; break;
+        case DIST_REVERSED: arr[i] = n - i; break;
+        case DIST_FEW_UNIQUE: arr[i] = (int)(randomU64() % 16); break;
+        case DIST_MOD1000: arr[i] = (int)(randomU64() % 1000); break;
+        case DIST_NORMAL: arr[i] = (int)generateNormalRandom(50.0, 10.0); break;
+        case DIST_SAWTOOTH: arr[i] = i % 1000; break;
+        default: arr[i] = i < n / 2 ? i : n - i; break;
+        }
+    }
+    // 1% of the elements swapped to random positions
+    if (dist == DIST_NEARLY_SORTED)
+        for (int s = 0; s < n / 100; s++)
+        {
+            int a = (int)(randomU64() % n), b = (int)(randomU64() % n);
+            int temp = arr[a];
+            arr[a] = arr[b];
+            arr[b] = temp;
+        }
+}
+
+// Adaptive Sort
+// The first two runs are scanned before anything else: input that is one run (ascending, or
+// strictly descending and reversed in place) is done, and two runs are merged once. A small input
+// that opens with a few long runs tries an insertion sort that gives up after 2n element moves.
+// Everything else is profiled by key range, then by run count estimated from sampled direction
+// changes, and one algorithm is picked. Thresholds come from sort_tuning.cfg, written by the
+// --tune calibration run on this host; compiled-in defaults apply when it is missing.
+#define AUTO_SAMPLES 1024
+#define AUTO_PROBE_RUNS 4   // runs scanned at the start of a small input before trying insertion
+#define AUTO_PROBE_LENGTH 16 // ...which must cover this many elements for the attempt
+#define AUTO_CONFIG_FILE "sort_tuning.cfg"
+
+typedef struct
+{
+    int insertionMaxN;          // at or below: insertion sort
+    int presortedInsertionMaxN; // at or below, opening with long runs: insertion sort, 2n move budget
+    int introMaxN;              // at or below: intro sort instead of pdqSort
+    double nearlySortedRuns;    // estimated runs per element at or below: natural merge sort
+    double countingRangeFactor; // key range at or below factor * n: counting sort
+    double narrowRangeFactor;   // key range at or below factor * n: radix sort
+    int radixMinN;              // at or above: radix sort for any key range
+} AutoSortConfig;
+
+AutoSortConfig autoConfig = {24, 256, 1024, 0.01, 4.0, 1.0, 4096};
+int autoConfigLoaded = 0;
+
+typedef struct
+{
+    int n;
+    int min, max;
+    long long range;
+} InputProfile;
+
+enum
+{
+    AUTO_PRESORTED,
+    AUTO_INSERTION,
+    AUTO_NATURAL_MERGE,
+    AUTO_COUNTING,
+    AUTO_RADIX,
+    AUTO_INTRO,
+    AUTO_PDQ,
+    AUTO_CHOICES
+};
+
+const char *autoChoiceNames[] = {"Presorted",  "Insertion Sort", "Natural Merge Sort", "Counting Sort",
+                                 "Radix Sort", "Intro Sort",     "PDQ Sort"};
+void (*autoChoiceSorts[])(int[], int) = {NULL,       insertionSort, naturalMergeSort, boundedCountingSort,
+                                         radixSort,  introSort,     pdqSort};
+
+void loadAutoConfig(const char *path)
+{
+    autoConfigLoaded = 1;
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+        return;
+
+    char line[256], key[128];
+    double value;
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (line[0] == '#' || sscanf(line, " %127[a-z_] = %lf", key, &value) != 2)
+            continue;
+        if (strcmp(key, "insertion_max_n") == 0)
+            autoConfig.insertionMaxN = (int)value;
+        else if (strcmp(key, "presorted_insertion_max_n") == 0)
+            autoConfig.presortedInsertionMaxN = (int)value;
+        else if (strcmp(key, "intro_max_n") == 0)
+            autoConfig.introMaxN = (int)value;
+        else if (strcmp(key, "nearly_sorted_runs") == 0)
+            autoConfig.nearlySortedRuns = value;
+        else if (strcmp(key, "counting_range_factor") == 0)
+            autoConfig.countingRangeFactor = value;
+        else if (strcmp(key, "narrow_range_factor") == 0)
+            autoConfig.narrowRangeFactor = value;
+        else if (strcmp(key, "radix_min_n") == 0)
+            autoConfig.radixMinN = (int)value;
+    }
+    fclose(fp);
+}
+
+int saveAutoConfig(const char *path, const AutoSortConfig *cfg)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        printf("Error opening %s for writing.\n", path);
+        return -1;
+    }
+    fprintf(fp, "# Adaptive sort thresholds, written by --tune on this host\n");
+    fprintf(fp, "insertion_max_n = %d\n", cfg->insertionMaxN);
+    fprintf(fp, "presorted_insertion_max_n = %d\n", cfg->presortedInsertionMaxN);
+    fprintf(fp, "intro_max_n = %d\n", cfg->introMaxN);
+    fprintf(fp, "nearly_sorted_runs = %g\n", cfg->nearlySortedRuns);
+    fprintf(fp, "counting_range_factor = %g\n", cfg->countingRangeFactor);
+    fprintf(fp, "narrow_range_factor = %g\n", cfg->narrowRangeFactor);
+    fprintf(fp, "radix_min_n = %d\n", cfg->radixMinN);
+    fclose(fp);
+    return 0;
+}
+
+// End of the non-descending run at the start of arr. Runs in unsorted data mostly end within a
+// few elements; one that survives 16 is continued in blocks of 16 pairs compared without branches,
+// so a long run costs one vectorized scan, and the block that breaks it is rescanned one by one.
+int ascendingRunEnd(const int arr[], int n)
+{
+    int i = 1;
+    while (i < n && i < 16 && arr[i] >= arr[i - 1])
+        i++;
+    if (i == 16)
+    {
+        for (; i + 16 <= n; i += 16)
+        {
+            const int *block = arr + i;
+            int outOfOrder = 0;
+            for (int k = 0; k < 16; k++)
+                outOfOrder |= block[k] < block[k - 1];
+            if (outOfOrder)
+                break;
+        }
+    }
+    while (i < n && arr[i] >= arr[i - 1])
+        i++;
+    return i;
+}
+
+// End of the strictly descending run at the start of arr, scanned like ascendingRunEnd
+int descendingRunEnd(const int arr[], int n)
+{
+    int i = 1;
+    while (i < n && i < 16 && arr[i] < arr[i - 1])
+        i++;
+    if (i == 16)
+    {
+        for (; i + 16 <= n; i += 16)
+        {
+            const int *block = arr + i;
+            int outOfOrder = 0;
+            for (int k = 0; k < 16; k++)
+                outOfOrder |= block[k] >= block[k - 1];
+            if (outOfOrder)
+                break;
+        }
+    }
+    while (i < n && arr[i] < arr[i - 1])
+        i++;
+    return i;
+}
+
+// Length of the run at the start of arr, split as naturalMergeSort splits them
+int leadingRun(const int arr[], int n)
+{
+    if (n < 2)
+        return n;
+    return arr[1] < arr[0] ? descendingRunEnd(arr, n) : ascendingRunEnd(arr, n);
+}
+
+// Sorts arr made of two runs, the second starting at mid: each is reversed if descending and the
+// left one is merged from a copy, as naturalMergeSort does, without scanning for the runs again
+void mergeTwoRuns(int arr[], int n, int mid)
+{
+    if (mid > 1 && arr[1] < arr[0])
+        intReverse(arr, mid);
+    if (n - mid > 1 && arr[mid + 1] < arr[mid])
+        intReverse(arr + mid, n - mid);
+    if (arr[mid - 1] <= arr[mid])
+        return;
+
+    int *buffer = (int *)malloc(mid * sizeof(int));
+    memcpy(buffer, arr, mid * sizeof(int));
+    int i = 0, j = mid, k = 0;
+    while (i < mid && j < n)
+        arr[k++] = arr[j] < buffer[i] ? arr[j++] : buffer[i++];
+    while (i < mid)
+        arr[k++] = buffer[i++];
+    free(buffer);
+}
+
+// Insertion sort of arr whose first start elements (at least one) are already in order. Short
+// moves shift one element at a time; an element displaced further is placed by binary search and
+// the block it skips is shifted with one memmove. Gives up (returning 0, arr still a permutation)
+// once more than budget elements have been shifted.
+int budgetedInsertionSort(int arr[], int n, int start, long budget)
+{
+    for (int i = start; i < n; i++)
+    {
+        int key = arr[i], j = i;
+        if (arr[i - 1] <= key)
+            continue;
+        while (j > 0 && i - j < 8 && arr[j - 1] > key)
+        {
+            arr[j] = arr[j - 1];
+            j--;
+        }
+        if (j > 0 && arr[j - 1] > key)
+        {
+            int lo = 0, hi = j - 1;
+            while (lo < hi)
+            {
+                int mid = lo + (hi - lo) / 2;
+                if (arr[mid] > key)
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            memmove(arr + lo + 1, arr + lo, (j - lo) * sizeof(int));
+            j = lo;
+        }
+        arr[j] = key;
+        budget -= i - j;
+        if (budget < 0)
+            return 0;
+    }
+    return 1;
+}
+
+// 1 when the sequence changes direction at arr[i + 1]. The two cases exclude each other, so they
+// are added rather than or-ed: no branches to mispredict on random data, and blocks vectorize.
+int isTurn(const int arr[], int i)
+{
+    return (arr[i] < arr[i + 1]) * (arr[i + 1] > arr[i + 2]) + (arr[i] > arr[i + 1]) * (arr[i + 1] < arr[i + 2]);
+}
+
+// Turns at every i below count, in blocks of 64 and then one at a time
+int countTurns(const int arr[], int count)
+{
+    int turns = 0, i = 0;
+    for (; i + 64 <= count; i += 64)
+    {
+        const int *block = arr + i;
+        for (int k = 0; k < 64; k++)
+            turns += isTurn(block, k);
+    }
+    for (; i < count; i++)
+        turns += isTurn(arr, i);
+    return turns;
+}
+
+void profileInput(const int arr[], int n, InputProfile *p)
+{
+    p->n = n;
+    findMinMax(arr, n, &p->min, &p->max);
+    if (n == 0)
+        p->min = p->max = 0;
+    p->range = (long long)p->max - p->min + 1;
+}
+
+// Runs per element, estimated from direction changes. Up to AUTO_SAMPLES triples are all checked;
+// larger inputs check about one in 32 (at most AUTO_SAMPLES), at fixed-seed positions so the
+// decision is reproducible for the same input.
+double estimateRunRatio(const int arr[], int n)
+{
+    if (n < 3)
+        return 0.0;
+    int samples = n - 2, turns = 0;
+    if (samples <= AUTO_SAMPLES)
+        return (double)countTurns(arr, samples) / samples;
+
+    samples = samples / 32 < 64 ? 64 : (samples / 32 > AUTO_SAMPLES ? AUTO_SAMPLES : samples / 32);
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    for (int s = 0; s < samples; s++)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        int i = (int)(((state >> 32) * (uint64_t)(n - 2)) >> 32);
+        turns += isTurn(arr, i);
+    }
+    return (double)turns / samples;
+}
+
+// Choice for input with more than two runs; the run ratio is only estimated when the key range
+// is too wide for counting sort
+int chooseSortAlgorithm(const int arr[], const InputProfile *p, const AutoSortConfig *cfg)
+{
+    int n = p->n;
+    if (p->range <= cfg->countingRangeFactor * n && p->range * sizeof(uint32_t) <= COUNTING_MAX_BYTES)
+        return AUTO_COUNTING;
+    if (estimateRunRatio(arr, n) <= cfg->nearlySortedRuns)
+        return AUTO_NATURAL_MERGE;
+    if (p->range <= cfg->narrowRangeFactor * n || n >= cfg->radixMinN)
+        return AUTO_RADIX;
+    return n <= cfg->introMaxN ? AUTO_INTRO : AUTO_PDQ;
+}
+
+// Sorts arr and returns the AUTO_* choice that was used
+int autoSortChoice(int arr[], int n)
+{
+    if (!autoConfigLoaded)
+        loadAutoConfig(AUTO_CONFIG_FILE);
+
+    int first = leadingRun(arr, n);
+    if (first == n)
+    {
+        if (n > 1 && arr[n - 1] < arr[0])
+            intReverse(arr, n);
+        return AUTO_PRESORTED;
+    }
+    // A small input whose long ascending first run breaks and then climbs again most likely has a
+    // few elements out of place: insert the rest straight away instead of scanning further. On
+    // failure the prefix is still sorted, so the checks below stay valid.
+    int small = n <= autoConfig.presortedInsertionMaxN && n > autoConfig.insertionMaxN;
+    int ascending = arr[1] >= arr[0];
+    if (small && ascending && first >= AUTO_PROBE_LENGTH && first + 1 < n && arr[first + 1] >= arr[first] &&
+        budgetedInsertionSort(arr, n, first, 2L * n))
+        return AUTO_INSERTION;
+
+    int second = first + leadingRun(arr + first, n - first);
+    if (second == n)
+    {
+        mergeTwoRuns(arr, n, first);
+        return AUTO_NATURAL_MERGE;
+    }
+
+    if (n <= autoConfig.insertionMaxN)
+    {
+        insertionSort(arr, n);
+        return AUTO_INSERTION;
+    }
+    if (small)
+    {
+        int probed = second;
+        for (int runs = 2; runs < AUTO_PROBE_RUNS && probed < AUTO_PROBE_LENGTH; runs++)
+            probed += leadingRun(arr + probed, n - probed);
+        if (probed >= AUTO_PROBE_LENGTH && budgetedInsertionSort(arr, n, ascending ? first : 1, 2L * n))
+            return AUTO_INSERTION;
+    }
+
+    InputProfile profile;
+    profileInput(arr, n, &profile);
+    int choice = chooseSortAlgorithm(arr, &profile, &autoConfig);
+    // The profile already holds the key range, so counting sort does not scan for it again
+    if (choice == AUTO_COUNTING)
+        countingSortKnownRange(arr, n, profile.min, profile.max, n >= PARALLEL_COUNTING_MIN ? hardwareThreads() : 1);
+    else
+        autoChoiceSorts[choice](arr, n);
+    return choice;
+}
+
+void autoSort(int arr[], int n)
+{
+    autoSortChoice(arr, n);
+}
+
+// Incremental Sorted Container
+// A sorted multiset of ints for append-heavy use that never re-sorts what is already sorted.
+// Inserts are appended to a buffer of SORTED_BUFFER ints. A full buffer is sorted with
+// autoSort and merged into level 0. Level i holds one sorted array of at most
+// SORTED_BUFFER * SORTED_GROWTH^(i + 1) ints, and a level that outgrows that is merged into
+// the next one (LSM leveling), so an element is moved about SORTED_GROWTH times per level.
+// Deletes are tombstones: a batch is appended to a tombstone buffer. Queries subtract
+// tombstones, and once they exceed an eighth of the live size every level is compacted into
+// one with the tombstones applied. A deleted value must be present (multiset difference).
+// Queries sort the buffers lazily and binary-search every level.
+#define SORTED_BUFFER 4096
+#define SORTED_GROWTH 8
+#define SORTED_MAX_LEVELS 16
+
+typedef struct
+{
+    int *buffer; // unsorted inserts
+    int bufferCount, bufferSorted;
+    int *tombstones;
+    int tombstoneCount, tombstoneCapacity, tombstonesSorted;
+    int *level[SORTED_MAX_LEVELS];
+    int levelCount[SORTED_MAX_LEVELS];
+    int levels;
+    long long size; // live elements
+} SortedContainer;
+
+void sortedInit(SortedContainer *sc)
+{
+    memset(sc, 0, sizeof(*sc));
+    sc->buffer = (int *)malloc(SORTED_BUFFER * sizeof(int));
+    sc->tombstoneCapacity = SORTED_BUFFER;
+    sc->tombstones = (int *)malloc(sc->tombstoneCapacity * sizeof(int));
+}
+
+void sortedFree(SortedContainer *sc)
+{
+    for (int l = 0; l < sc->levels; l++)
+        free(sc->level[l]);
+    free(sc->tombstones);
+    free(sc->buffer);
+}
+
+// Merges sorted a and b into out, which may not overlap either
+void mergeSortedInts(const int a[], int na, const int b[], int nb, int out[])
+{
+    int i = 0, j = 0, k = 0;
+    while (i < na && j < nb)
+        out[k++] = b[j] < a[i] ? b[j++] : a[i++];
+    if (i < na)
+        memcpy(out + k, a + i, (na - i) * sizeof(int));
+    if (j < nb)
+        memcpy(out + k + na - i, b + j, (nb - j) * sizeof(int));
+}
+
+// Merges sorted values into level l and pushes levels that grew past their capacity down
+void sortedMergeInto(SortedContainer *sc, int l, int values[], int count, int ownsValues)
+{
+    long long capacity = SORTED_BUFFER;
+    for (; l < SORTED_MAX_LEVELS; l++)
+    {
+        capacity *= SORTED_GROWTH;
+        if (l == sc->levels)
+            sc->levels++;
+        int merged = sc->levelCount[l] + count;
+        int *out = (int *)malloc((merged > 0 ? merged : 1) * sizeof(int));
+        mergeSortedInts(sc->level[l], sc->levelCount[l], values, count, out);
+        free(sc->level[l]);
+        if (ownsValues)
+            free(values);
+        sc->level[l] = out;
+        sc->levelCount[l] = merged;
+        if (merged <= capacity || l == SORTED_MAX_LEVELS - 1)
+            return;
+        values = out;
+        count = merged;
+        ownsValues = 1;
+        sc->level[l] = NULL;
+        sc->levelCount[l] = 0;
+    }
+}
+
+void sortedFlushBuffer(SortedContainer *sc)
+{
+    if (sc->bufferCount == 0)
+        return;
+    if (!sc->bufferSorted)
+        autoSort(sc->buffer, sc->bufferCount);
+    sortedMergeInto(sc, 0, sc->buffer, sc->bufferCount, 0);
+    sc->bufferCount = 0;
+    sc->bufferSorted = 0;
+}
+
+void sortedInsert(SortedContainer *sc, const int values[], int n)
+{
+    for (int i = 0; i < n;)
+    {
+        int take = SORTED_BUFFER - sc->bufferCount;
+        take = take < n - i ? take : n - i;
+        memcpy(sc->buffer + sc->bufferCount, values + i, take * sizeof(int));
+        sc->bufferCount += take;
+        sc->bufferSorted = 0;
+        i += take;
+        if (sc->bufferCount == SORTED_BUFFER)
+            sortedFlushBuffer(sc);
+    }
+    sc->size += n;
+}
+
+static inline void sortedSortTombstones(SortedContainer *sc)
+{
+    if (!sc->tombstonesSorted)
+        autoSort(sc->tombstones, sc->tombstoneCount);
+    sc->tombstonesSorted = 1;
+}
+
+// Merges every level and the buffer into one level and removes the tombstoned elements
+void sortedCompact(SortedContainer *sc)
+{
+    sortedFlushBuffer(sc);
+    sortedSortTombstones(sc);
+    int total = 0, last = -1;
+    for (int l = 0; l < sc->levels; l++)
+        if (sc->levelCount[l] > 0)
+        {
+            if (last >= 0)
+            {
+                int *out = (int *)malloc((sc->levelCount[l] + sc->levelCount[last]) * sizeof(int));
+                mergeSortedInts(sc->level[last], sc->levelCount[last], sc->level[l], sc->levelCount[l], out);
+                free(sc->level[last]);
+                free(sc->level[l]);
+                sc->level[l] = out;
+                sc->levelCount[l] += sc->levelCount[last];
+                sc->level[last] = NULL;
+                sc->levelCount[last] = 0;
+            }
+            last = l;
+        }
+    if (last < 0)
+    {
+        sc->tombstoneCount = 0;
+        return;
+    }
+
+    // Multiset difference in place: each tombstone removes one equal element
+    int *arr = sc->level[last], n = sc->levelCount[last], t = 0;
+    for (int i = 0; i < n; i++)
+    {
+        while (t < sc->tombstoneCount && sc->tombstones[t] < arr[i])
+            t++;
+        if (t < sc->tombstoneCount && sc->tombstones[t] == arr[i])
+            t++;
+        else
+            arr[total++] = arr[i];
+    }
+    sc->levelCount[last] = total;
+    sc->tombstoneCount = 0;
+    sc->size = total;
+}
+
+void sortedDelete(SortedContainer *sc, const int values[], int n)
+{
+    if (sc->tombstoneCount + n > sc->tombstoneCapacity)
+    {
+        while (sc->tombstoneCount + n > sc->tombstoneCapacity)
+            sc->tombstoneCapacity *= 2;
+        sc->tombstones = (int *)realloc(sc->tombstones, sc->tombstoneCapacity * sizeof(int));
+    }
+    memcpy(sc->tombstones + sc->tombstoneCount, values, n * sizeof(int));
+    sc->tombstoneCount += n;
+    sc->tombstonesSorted = 0;
+    sc->size -= n;
+    if (sc->tombstoneCount > SORTED_BUFFER && sc->tombstoneCount > sc->size / 8)
+        sortedCompact(sc);
+}
+
+// Number of live elements x with lo <= x <= hi
+long long sortedCountRange(SortedContainer *sc, int lo, int hi)
+{
+    if (lo > hi)
+        return 0;
+    if (!sc->bufferSorted)
+        autoSort(sc->buffer, sc->bufferCount);
+    sc->bufferSorted = 1;
+    sortedSortTombstones(sc);
+    long long count = intUpperBound(sc->buffer, sc->bufferCount, hi) - intLowerBound(sc->buffer, sc->bufferCount, lo);
+    for (int l = 0; l < sc->levels; l++)
+        count += intUpperBound(sc->level[l], sc->levelCount[l], hi) - intLowerBound(sc->level[l], sc->levelCount[l], lo);
+    return count - (intUpperBound(sc->tombstones, sc->tombstoneCount, hi) -
+                    intLowerBound(sc->tombstones, sc->tombstoneCount, lo));
+}
+
+// Writes the live elements x with lo <= x <= hi to out in order, at most maxOut of them;
+// returns how many were written
+int sortedRange(SortedContainer *sc, int lo, int hi, int out[], int maxOut)
+{
+    if (lo > hi)
+        return 0;
+    if (!sc->bufferSorted)
+        autoSort(sc->buffer, sc->bufferCount);
+    sc->bufferSorted = 1;
+    sortedSortTombstones(sc);
+
+    // One slice per level plus the buffer, merged by repeated minimum (few sources)
+    const int *begin[SORTED_MAX_LEVELS + 1], *end[SORTED_MAX_LEVELS + 1];
+    int sources = 0;
+    for (int s = 0; s <= sc->levels; s++)
+    {
+        const int *arr = s < sc->levels ? sc->level[s] : sc->buffer;
+        int n = s < sc->levels ? sc->levelCount[s] : sc->bufferCount;
+        begin[sources] = arr + intLowerBound(arr, n, lo);
+        end[sources] = arr + intUpperBound(arr, n, hi);
+        if (begin[sources] < end[sources])
+            sources++;
+    }
+    const int *tomb = sc->tombstones + intLowerBound(sc->tombstones, sc->tombstoneCount, lo);
+    const int *tombEnd = sc->tombstones + intUpperBound(sc->tombstones, sc->tombstoneCount, hi);
+
+    int written = 0;
+    while (sources > 0 && written < maxOut)
+    {
+        int best = 0;
+        for (int s = 1; s < sources; s++)
+            if (*begin[s] < *begin[best])
+                best = s;
+        int x = *begin[best]++;
+        if (begin[best] == end[best])
+        {
+            begin[best] = begin[--sources];
+            end[best] = end[sources];
+        }
+        while (tomb < tombEnd && *tomb < x)
+            tomb++;
+        if (tomb < tombEnd && *tomb == x)
+            tomb++;
+        else
+            out[written++] = x;
+    }
+    return written;
+}
+
+// Loser Tree
+// Tournament tree over k sources for k-way merging: tree[0] holds the index of the smallest
+// source, tree[1..k-1] the loser of each match. After the winner advances only its path to
+// the root is replayed, log2(k) comparisons per element. Exhausted sources lose every match.
+// DEFINE_LOSER_TREE(Type, name, KEY_T) defines the tree Type over heads of type KEY_T with
+// nameInit, nameReplay and nameFree; LoserTree merges ints, LoserTree64 64-bit keys.
+#define DEFINE_LOSER_TREE(Type, name, KEY_T)                                         \
+    typedef struct                                                                   \
+    {                                                                                \
+        int k;                                                                       \
+        int *tree;                                                                   \
+        const KEY_T *key;                                                            \
+        const char *done;                                                            \
+    } Type;                                                                          \
+                                                                                     \
+    static inline int name##Beats(const Type *lt, int a, int b)                      \
+    {                                                                                \
+        if (lt->done[a])                                                             \
+            return 0;                                                                \
+        if (lt->done[b])                                                             \
+            return 1;                                                                \
+        return lt->key[a] < lt->key[b] || (lt->key[a] == lt->key[b] && a < b);       \
+    }                                                                                \
+                                                                                     \
+    int name##Build(Type *lt, int node)                                              \
+    {                                                                                \
+        if (node >= lt->k)                                                           \
+            return node - lt->k;                                                     \
+        int left = name##Build(lt, 2 * node);                                        \
+        int right = name##Build(lt, 2 * node + 1);                                   \
+        if (name##Beats(lt, left, right))                                            \
+        {                                                                            \
+            lt->tree[node] = right;                                                  \
+            return left;                                                             \
+        }                                                                            \
+        lt->tree[node] = left;                                                       \
+        return right;                                                                \
+    }                                                                                \
+                                                                                     \
+    /* key[i] is the current head of source i, done[i] is set once source i is exhausted */ \
+    void name##Init(Type *lt, int k, const KEY_T *key, const char *done)             \
+    {                                                                                \
+        lt->k = k;                                                                   \
+        lt->key = key;                                                               \
+        lt->done = done;                                                             \
+        lt->tree = (int *)malloc((k > 1 ? k : 2) * sizeof(int));                     \
+        lt->tree[0] = k > 1 ? name##Build(lt, 1) : 0;                                \
+    }                                                                                \
+                                                                                     \
+    /* Call after key[winner] or done[winner] changed */                             \
+    static inline void name##Replay(Type *lt)                                        \
+    {                                                                                \
+        int winner = lt->tree[0];                                                    \
+        for (int node = (winner + lt->k) / 2; node > 0; node /= 2)                   \
+        {                                                                            \
+            if (name##Beats(lt, lt->tree[node], winner))                             \
+            {                                                                        \
+                int t = lt->tree[node];                                              \
+                lt->tree[node] = winner;                                             \
+                winner = t;                                                          \
+            }                                                                        \
+        }                                                                            \
+        lt->tree[0] = winner;                                                        \
+    }                                                                                \
+                                                                                     \
+    void name##Free(Type *lt)                                                        \
+    {                                                                                \
+        free(lt->tree);                                                              \
+    }
+
+DEFINE_LOSER_TREE(LoserTree, loserTree, int)
+DEFINE_LOSER_TREE(LoserTree64, loserTree64, uint64_t)
+
+// External Sort
+// Sorts a file of native-endian binary ints that may be far larger than memory. Runs of half
+// the memory budget are sorted with radixSort (the other half is its scratch buffer) and written
+// as spill files, then merged with a loser tree. Every run is read through two buffers: a single
+// prefetch thread fills one while the merge consumes the other. When the runs do not all fit in
+// the budget with EXTERNAL_MIN_BUFFER per buffer, they are merged in several passes.
+#define EXTERNAL_MIN_BUFFER (1 << 20)
+
+typedef struct
+{
+    FILE *fp;
+    int *buffer[2];
+    size_t count[2];
+    int ready[2];
+    int front;
+    size_t pos;
+    size_t capacity;
+} RunReader;
+
+typedef struct
+{
+    RunReader *runs;
+    int *queue;
+    int capacity, head, tail, stop;
+    pthread_mutex_t lock;
+    pthread_cond_t requestPosted, bufferFilled;
+    pthread_t thread;
+} PrefetchService;
+
+void *prefetchThread(void *arg)
+{
+    PrefetchService *svc = (PrefetchService *)arg;
+    pthread_mutex_lock(&svc->lock);
+    for (;;)
+    {
+        while (svc->head == svc->tail && !svc->stop)
+            pthread_cond_wait(&svc->requestPosted, &svc->lock);
+        if (svc->head == svc->tail)
+            break;
+        int request = svc->queue[svc->head++ % svc->capacity];
+        pthread_mutex_unlock(&svc->lock);
+
+        RunReader *run = &svc->runs[request / 2];
+        int b = request % 2;
+        size_t got = fread(run->buffer[b], sizeof(int), run->capacity, run->fp);
+
+        pthread_mutex_lock(&svc->lock);
+        run->count[b] = got;
+        run->ready[b] = 1;
+        pthread_cond_broadcast(&svc->bufferFilled);
+    }
+    pthread_mutex_unlock(&svc->lock);
+    return NULL;
+}
+
+void prefetchRequest(PrefetchService *svc, int run, int b)
+{
+    pthread_mutex_lock(&svc->lock);
+    svc->runs[run].ready[b] = 0;
+    svc->queue[svc->tail++ % svc->capacity] = run * 2 + b;
+    pthread_cond_signal(&svc->requestPosted);
+    pthread_mutex_unlock(&svc->lock);
+}
+
+void prefetchWait(PrefetchService *svc, int run, int b)
+{
+    pthread_mutex_lock(&svc->lock);
+    while (!svc->runs[run].ready[b])
+        pthread_cond_wait(&svc->bufferFilled, &svc->lock);
+    pthread_mutex_unlock(&svc->lock);
+}
+
+// Moves run r to its next element; returns 0 once the run is exhausted
+int runAdvance(PrefetchService *svc, int r)
+{
+    RunReader *run = &svc->runs[r];
+    if (++run->pos < run->count[run->front])
+        return 1;
+
+    int consumed = run->front, next = 1 - consumed;
+    prefetchWait(svc, r, next);
+    if (run->count[next] == 0)
+        return 0;
+    run->front = next;
+    run->pos = 0;
+    prefetchRequest(svc, r, consumed);
+    return 1;
+}
+
+// Merges k sorted run files into output with bufferInts ints per buffer
+int mergeRunFiles(char **inputs, int k, const char *output, size_t bufferInts)
+{
+    FILE *out = fopen(output, "wb");
+    if (out == NULL)
+    {
+        printf("Error opening %s for writing.\n", output);
+        return -1;
+    }
+    if (k == 0)
+        return fclose(out) == 0 ? 0 : -1;
+
+    PrefetchService svc;
+    svc.runs = (RunReader *)calloc(k, sizeof(RunReader));
+    svc.capacity = 2 * k;
+    svc.queue = (int *)malloc(svc.capacity * sizeof(int));
+    svc.head = svc.tail = svc.stop = 0;
+    pthread_mutex_init(&svc.lock, NULL);
+    pthread_cond_init(&svc.requestPosted, NULL);
+    pthread_cond_init(&svc.bufferFilled, NULL);
+    pthread_create(&svc.thread, NULL, prefetchThread, &svc);
+
+    int *key = (int *)malloc(k * sizeof(int));
+    char *done = (char *)calloc(k, 1);
+    int status = 0;
+
+    for (int r = 0; r < k; r++)
+    {
+        RunReader *run = &svc.runs[r];
+        run->fp = fopen(inputs[r], "rb");
+        run->capacity = bufferInts;
+        run->buffer[0] = (int *)malloc(bufferInts * sizeof(int));
+        run->buffer[1] = (int *)malloc(bufferInts * sizeof(int));
+        if (run->fp == NULL)
+        {
+            printf("Error opening run file %s.\n", inputs[r]);
+            done[r] = 1;
+            status = -1;
+            continue;
+        }
+        prefetchRequest(&svc, r, 0);
+        prefetchRequest(&svc, r, 1);
+    }
+
+    for (int r = 0; r < k && status == 0; r++)
+    {
+        prefetchWait(&svc, r, 0);
+        if (svc.runs[r].count[0] == 0)
+            done[r] = 1;
+        else
+            key[r] = svc.runs[r].buffer[0][0];
+    }
+
+    int *outBuffer = (int *)malloc(bufferInts * sizeof(int));
+    size_t outCount = 0;
+    LoserTree lt;
+    loserTreeInit(&lt, k, key, done);
+
+    while (status == 0 && !done[lt.tree[0]])
+    {
+        int r = lt.tree[0];
+        outBuffer[outCount++] = key[r];
+        if (outCount == bufferInts)
+        {
+            if (fwrite(outBuffer, sizeof(int), outCount, out) != outCount)
+                status = -1;
+            outCount = 0;
+        }
+
+        if (runAdvance(&svc, r))
+            key[r] = svc.runs[r].buffer[svc.runs[r].front][svc.runs[r].pos];
+        else
+            done[r] = 1;
+        loserTreeReplay(&lt);
+    }
+    if (status == 0 && fwrite(outBuffer, sizeof(int), outCount, out) != outCount)
+        status = -1;
+    if (status != 0)
+        printf("Error writing %s.\n", output);
+
+    // The prefetch thread drains every queued read before it exits
+    pthread_mutex_lock(&svc.lock);
+    svc.stop = 1;
+    pthread_cond_signal(&svc.requestPosted);
+    pthread_mutex_unlock(&svc.lock);
+    pthread_join(svc.thread, NULL);
+
+    for (int r = 0; r < k; r++)
+    {
+        if (svc.runs[r].fp != NULL)
+            fclose(svc.runs[r].fp);
+        free(svc.runs[r].buffer[0]);
+        free(svc.runs[r].buffer[1]);
+    }
+    if (fclose(out) != 0)
+        status = -1;
+
+    loserTreeFree(&lt);
+    pthread_cond_destroy(&svc.bufferFilled);
+    pthread_cond_destroy(&svc.requestPosted);
+    pthread_mutex_destroy(&svc.lock);
+    free(outBuffer);
+    free(done);
+    free(key);
+    free(svc.queue);
+    free(svc.runs);
+    return status;
+}
+
+char *runFileName(const char *tmpDir, int pass, int index)
+{
+    char *name = (char *)malloc(strlen(tmpDir) + 64);
+    sprintf(name, "%s/sortrun_%d_%d_%d.bin", tmpDir, (int)getpid(), pass, index);
+    return name;
+}
+
+void removeRunFiles(char **names, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        remove(names[i]);
+        free(names[i]);
+    }
+    free(names);
+}
+
+// Returns the number of runs written, or -1 on error (a read error, a trailing partial int or a
+// failed write; the runs written so far are removed)
+int createSortedRuns(FILE *in, size_t runInts, const char *tmpDir, char ***names)
+{
+    int *chunk = (int *)malloc(runInts * sizeof(int));
+    int numRuns = 0, capacity = 16;
+    *names = (char **)malloc(capacity * sizeof(char *));
+
+    for (;;)
+    {
+        size_t bytes = fread(chunk, 1, runInts * sizeof(int), in);
+        if (bytes % sizeof(int) != 0 || (bytes < runInts * sizeof(int) && ferror(in)))
+        {
+            printf("Error reading input: read failed or input is not a whole number of ints.\n");
+            removeRunFiles(*names, numRuns);
+            free(chunk);
+            return -1;
+        }
+        size_t n = bytes / sizeof(int);
+        if (n == 0)
+            break;
+        radixSort(chunk, (int)n);
+
+        if (numRuns == capacity)
+        {
+            capacity *= 2;
+            *names = (char **)realloc(*names, capacity * sizeof(char *));
+        }
+        char *name = runFileName(tmpDir, 0, numRuns);
+        (*names)[numRuns++] = name;
+        FILE *run = fopen(name, "wb");
+        if (run == NULL || fwrite(chunk, sizeof(int), n, run) != n || fclose(run) != 0)
+        {
+            printf("Error writing run file %s.\n", name);
+            removeRunFiles(*names, numRuns);
+            free(chunk);
+            return -1;
+        }
+    }
+
+    free(chunk);
+    return numRuns;
+}
+
+// Returns the number of initial runs, or -1 on error
+int externalSort(const char *input, const char *output, size_t memoryBytes, const char *tmpDir)
+{
+    FILE *in = fopen(input, "rb");
+    if (in == NULL)
+    {
+        printf("Error opening %s.\n", input);
+        return -1;
+    }
+
+    // A budget below two buffers (0 from an empty or non-numeric --external-sort argument) would
+    // give empty runs; like streamSort's minimum chunk, it is raised to a working size
+    if (memoryBytes < 2 * EXTERNAL_MIN_BUFFER)
+        memoryBytes = 2 * EXTERNAL_MIN_BUFFER;
+    size_t runInts = memoryBytes / 2 / sizeof(int);
+    if (runInts > INT_MAX)
+        runInts = INT_MAX;
+    char **runs;
+    int numRuns = createSortedRuns(in, runInts, tmpDir, &runs);
+    fclose(in);
+    if (numRuns < 0)
+        return -1;
+    int initialRuns = numRuns;
+
+    // Two buffers per input run plus one for the output
+    int maxFanIn = (int)(memoryBytes / EXTERNAL_MIN_BUFFER / 2) - 1;
+    if (maxFanIn < 2)
+        maxFanIn = 2;
+
+    for (int pass = 1; numRuns > maxFanIn; pass++)
+    {
+        int merged = (numRuns + maxFanIn - 1) / maxFanIn;
+        char **next = (char **)malloc(merged * sizeof(char *));
+        for (int m = 0; m < merged; m++)
+        {
+            int first = m * maxFanIn;
+            int k = numRuns - first < maxFanIn ? numRuns - first : maxFanIn;
+            next[m] = runFileName(tmpDir, pass, m);
+            if (mergeRunFiles(runs + first, k, next[m], memoryBytes / (2 * k + 1) / sizeof(int)) != 0)
+            {
+                removeRunFiles(runs, numRuns);
+                removeRunFiles(next, m + 1);
+                return -1;
+            }
+        }
+        removeRunFiles(runs, numRuns);
+        runs = next;
+        numRuns = merged;
+    }
+
+    int status = mergeRunFiles(runs, numRuns, output, memoryBytes / (2 * (numRuns > 0 ? numRuns : 1) + 1) / sizeof(int));
+    removeRunFiles(runs, numRuns);
+    return status == 0 ? initialRuns : -1;
+}
+
+// Distributed Sort
+// A coordinator and worker processes on one host. The coordinator reads a random sample of the
+// input file and picks workers - 1 splitters. It then streams the file once and sends each
+// element over a Unix domain socket to the worker that owns its key range. Each worker receives
+// its partition, sorts it with radixSort and writes its own range file, <prefix>.<worker>.
+// Concatenating the files in worker order gives the sorted input, so nothing is merged at the
+// end. Only the workers hold keys in memory; the coordinator needs one chunk and a send buffer
+// per worker. A key equal to a run of splitters may go to any worker that run bounds, so such
+// keys are spread round-robin over those workers instead of piling up on one.
+#define DISTRIBUTED_OVERSAMPLING 64
+#define DISTRIBUTED_CHUNK (1 << 20) // ints read from the input at a time
+#define DISTRIBUTED_SEND (1 << 14)  // ints buffered per worker before a send
+#define DISTRIBUTED_MAX_WORKERS 256
+
+typedef struct
+{
+    long long count;
+    int min, max;
+    double receiveSeconds, sortSeconds, writeSeconds;
+    int status;  // 0, or -1 when the worker failed
+    long peakKB; // filled in by the coordinator from wait4()
+} WorkerReport;
+
+// Returns 0 once every byte is sent, -1 on error (a dead peer gives EPIPE, not SIGPIPE)
+int sendAll(int fd, const void *data, size_t bytes)
+{
+    const char *p = (const char *)data;
+    while (bytes > 0)
+    {
+        ssize_t sent = send(fd, p, bytes, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent <= 0)
+            return -1;
+        p += sent;
+        bytes -= sent;
+    }
+    return 0;
+}
+
+// Reads until bytes are read or the peer closes; returns the number of bytes read
+size_t receiveAll(int fd, void *data, size_t bytes)
+{
+    char *p = (char *)data;
+    size_t total = 0;
+    while (total < bytes)
+    {
+        ssize_t got = recv(fd, p + total, bytes - total, 0);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            break;
+        total += got;
+    }
+    return total;
+}
+
+char *rangeFileName(const char *prefix, int worker)
+{
+    char *name = (char *)malloc(strlen(prefix) + 16);
+    sprintf(name, "%s.%03d", prefix, worker);
+    return name;
+}
+
+// Worker for key x: splitters[w - 1] < x <= splitters[w] selects worker w. A key equal to
+// splitters[lo..hi-1] may go to any worker from lo to hi.
+static inline int distributedOwner(const int splitters[], int count, int x, unsigned *spread)
+{
+    int lo = 0, hi = count;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (splitters[mid] < x)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == count || splitters[lo] != x)
+        return lo;
+
+    int last = lo + 1;
+    hi = count;
+    while (last < hi)
+    {
+        int mid = (last + hi) / 2;
+        if (splitters[mid] == x)
+            last = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo + (int)((*spread)++ % (unsigned)(last - lo + 1));
+}
+
+// Runs in the forked child: receive until the coordinator shuts its side down, sort, write the
+// range file, send the report back
+void distributedWorker(int fd, const char *prefix, int worker)
+{
+    WorkerReport report = {0, 0, 0, 0.0, 0.0, 0.0, 0, 0};
+    size_t capacity = (size_t)DISTRIBUTED_CHUNK * sizeof(int), bytes = 0;
+    char *data = (char *)malloc(capacity);
+
+    double start = wallTime();
+    for (;;)
+    {
+        if (bytes == capacity)
+        {
+            capacity *= 2;
+            data = (char *)realloc(data, capacity);
+        }
+        size_t got = receiveAll(fd, data + bytes, capacity - bytes);
+        bytes += got;
+        if (bytes < capacity)
+            break;
+    }
+    report.receiveSeconds = wallTime() - start;
+
+    int *keys = (int *)data;
+    report.count = bytes / sizeof(int);
+    if (report.count > INT_MAX)
+        report.status = -1;
+    else
+    {
+        start = wallTime();
+        radixSort(keys, (int)report.count);
+        report.sortSeconds = wallTime() - start;
+        if (report.count > 0)
+        {
+            report.min = keys[0];
+            report.max = keys[report.count - 1];
+        }
+
+        start = wallTime();
+        char *name = rangeFileName(prefix, worker);
+        FILE *out = fopen(name, "wb");
+        if (out == NULL || fwrite(keys, sizeof(int), report.count, out) != (size_t)report.count || fclose(out) != 0)
+            report.status = -1;
+        report.writeSeconds = wallTime() - start;
+        free(name);
+    }
+
+    free(data);
+    _exit(sendAll(fd, &report, sizeof(report)) == 0 ? 0 : 1);
+}
+
+// Sorts the binary int file input into workers range files <prefix>.000, <prefix>.001, ...
+// reports (workers entries, may be NULL) receives what each worker did. Returns 0 or -1.
+int distributedSort(const char *input, const char *prefix, int workers, WorkerReport reports[])
+{
+    if (workers < 1 || workers > DISTRIBUTED_MAX_WORKERS)
+    {
+        printf("Error: worker count must be between 1 and %d.\n", DISTRIBUTED_MAX_WORKERS);
+        return -1;
+    }
+    FILE *in = fopen(input, "rb");
+    if (in == NULL)
+    {
+        printf("Error opening %s.\n", input);
+        return -1;
+    }
+    fseeko(in, 0, SEEK_END);
+    long long bytes = (long long)ftello(in);
+    if (bytes < 0 || bytes % (long long)sizeof(int) != 0)
+    {
+        printf("Error reading %s: read failed or input is not a whole number of ints.\n", input);
+        fclose(in);
+        return -1;
+    }
+    long long total = bytes / (long long)sizeof(int);
+
+    // Splitters: evenly spaced order statistics of a sorted random sample
+    int samples = workers * DISTRIBUTED_OVERSAMPLING;
+    int *sample = (int *)calloc(samples, sizeof(int));
+    int *splitters = (int *)malloc(workers * sizeof(int));
+    for (int i = 0; i < samples && total > 0; i++)
+    {
+        fseeko(in, (off_t)(randomU64() % (uint64_t)total) * sizeof(int), SEEK_SET);
+        if (fread(&sample[i], sizeof(int), 1, in) != 1)
+            sample[i] = 0;
+    }
+    pdqSort(sample, samples);
+    for (int w = 0; w < workers - 1; w++)
+        splitters[w] = sample[(w + 1) * DISTRIBUTED_OVERSAMPLING - 1];
+    free(sample);
+    rewind(in);
+
+    int *fds = (int *)malloc(workers * sizeof(int));
+    pid_t *pids = (pid_t *)malloc(workers * sizeof(pid_t));
+    int started = 0, status = 0;
+    fflush(stdout);
+    for (; started < workers; started++)
+    {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+        {
+            status = -1;
+            break;
+        }
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            close(sv[0]);
+            close(sv[1]);
+            status = -1;
+            break;
+        }
+        if (pid == 0)
+        {
+            // Earlier workers' sockets must close here too, or they would never see EOF
+            close(sv[0]);
+            for (int u = 0; u < started; u++)
+                close(fds[u]);
+            distributedWorker(sv[1], prefix, started);
+        }
+        close(sv[1]);
+        fds[started] = sv[0];
+        pids[started] = pid;
+    }
+
+    int *chunk = (int *)malloc(DISTRIBUTED_CHUNK * sizeof(int));
+    int *outgoing = (int *)malloc((size_t)workers * DISTRIBUTED_SEND * sizeof(int));
+    int *fill = (int *)calloc(workers, sizeof(int));
+    unsigned spread = 0;
+    size_t n;
+    while (status == 0 && (n = fread(chunk, sizeof(int), DISTRIBUTED_CHUNK, in)) > 0)
+    {
+        for (size_t i = 0; i < n && status == 0; i++)
+        {
+            int w = distributedOwner(splitters, workers - 1, chunk[i], &spread);
+            int *buffer = outgoing + (size_t)w * DISTRIBUTED_SEND;
+            buffer[fill[w]++] = chunk[i];
+            if (fill[w] == DISTRIBUTED_SEND)
+            {
+                status = sendAll(fds[w], buffer, DISTRIBUTED_SEND * sizeof(int));
+                fill[w] = 0;
+            }
+        }
+    }
+    if (status == 0 && ferror(in))
+    {
+        printf("Error reading %s.\n", input);
+        status = -1;
+    }
+    for (int w = 0; w < started; w++)
+    {
+        if (status == 0)
+            status = sendAll(fds[w], outgoing + (size_t)w * DISTRIBUTED_SEND, fill[w] * sizeof(int));
+        shutdown(fds[w], SHUT_WR);
+    }
+    fclose(in);
+
+    for (int w = 0; w < started; w++)
+    {
+        WorkerReport report;
+        int childStatus;
+        struct rusage usage;
+        memset(&report, 0, sizeof(report));
+        memset(&usage, 0, sizeof(usage));
+        if (receiveAll(fds[w], &report, sizeof(report)) != sizeof(report))
+            report.status = -1;
+        close(fds[w]);
+        if (wait4(pids[w], &childStatus, 0, &usage) < 0 || !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0)
+            report.status = -1;
+        report.peakKB = usage.ru_maxrss;
+        if (report.status != 0)
+        {
+            printf("Error: worker %d failed.\n", w);
+            status = -1;
+        }
+        if (reports)
+            reports[w] = report;
+    }
+    if (started < workers)
+        printf("Error: could not start worker %d.\n", started);
+
+    free(fill);
+    free(outgoing);
+    free(chunk);
+    free(pids);
+    free(fds);
+    free(splitters);
+    return status;
+}
+
+// Throughput and load imbalance of one run; returns max / mean keys per worker
+double printDistributedReport(const WorkerReport reports[], int workers, double seconds)
+{
+    long long total = 0, largest = 0;
+    double slowestSort = 0.0, sortSum = 0.0;
+    printf("%6s %12s %12s %12s %9s %9s %9s %10s\n", "worker", "keys", "min", "max", "recv (s)", "sort (s)",
+           "write (s)", "peak MB");
+    for (int w = 0; w < workers; w++)
+    {
+        const WorkerReport *r = &reports[w];
+        printf("%6d %12lld %12d %12d %9.3f %9.3f %9.3f %10.1f\n", w, r->count, r->min, r->max, r->receiveSeconds,
+               r->sortSeconds, r->writeSeconds, r->peakKB / 1024.0);
+        total += r->count;
+        if (r->count > largest)
+            largest = r->count;
+        sortSum += r->sortSeconds;
+        if (r->sortSeconds > slowestSort)
+            slowestSort = r->sortSeconds;
+    }
+    double imbalance = total > 0 ? (double)largest * workers / total : 1.0;
+    printf("%lld keys in %.3f s: %.1f Mkeys/s, %.1f MB/s\n", total, seconds, total / seconds / 1e6,
+           total * sizeof(int) / seconds / (1 << 20));
+    printf("Load imbalance: largest partition %.3fx the mean, slowest sort %.3fx the mean\n", imbalance,
+           sortSum > 0.0 ? slowestSort * workers / sortSum : 1.0);
+    return imbalance;
+}
+
+// Streaming Sort
+// Sorts binary records arriving on stdin or from a file and writes them to stdout, so the sort
+// can sit in a shell pipeline. Three threads overlap the work: a reader decodes the input into
+// chunks of 64-bit keys, the main thread sorts each chunk with uint64RadixSort (which skips the
+// constant upper bytes of int records) and spills it as a run file, and after the last chunk
+// it merges the runs with a loser tree while a writer thread encodes and writes the output
+// blocks. The last chunk stays in memory, so an input that fits in one chunk never touches the
+// disk. Regular files, including a redirected stdin, are read through mmap; pipes through large
+// read() calls. Memory: four chunks of memoryBytes / 4 (reading, sorting, radix scratch and the
+// previous run waiting to be spilled). stdout carries the data, so messages go to stderr.
+#define STREAM_READ_BYTES (1 << 20)  // bytes per read() from a pipe
+#define STREAM_BLOCK (1 << 16)       // keys per output block handed to the writer
+#define STREAM_OUTPUT_BLOCKS 4       // output blocks in flight between merge and writer
+#define STREAM_MIN_CHUNK (1 << 16)   // keys
+#define STREAM_MIN_MERGE (1 << 14)   // keys buffered per spilled run while merging
+
+enum
+{
+    STREAM_INT32,
+    STREAM_UINT64
+};
+
+const char *streamTypeNames[] = {"int", "uint64"};
+
+typedef struct
+{
+    uint64_t *keys;
+    size_t count;
+} StreamBlock;
+
+// Hands blocks from one thread to another. Every block comes from a fixed set that circulates
+// between a full and an empty queue, so a push never waits.
+typedef struct
+{
+    StreamBlock **items;
+    int capacity, head, tail;
+    pthread_mutex_t lock;
+    pthread_cond_t posted;
+} StreamQueue;
+
+void streamQueueInit(StreamQueue *q, int capacity)
+{
+    q->items = (StreamBlock **)malloc(capacity * sizeof(StreamBlock *));
+    q->capacity = capacity;
+    q->head = q->tail = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->posted, NULL);
+}
+
+void streamQueuePush(StreamQueue *q, StreamBlock *block)
+{
+    pthread_mutex_lock(&q->lock);
+    q->items[q->tail++ % q->capacity] = block;
+    pthread_cond_signal(&q->posted);
+    pthread_mutex_unlock(&q->lock);
+}
+
+StreamBlock *streamQueuePop(StreamQueue *q)
+{
+    pthread_mutex_lock(&q->lock);
+    while (q->head == q->tail)
+        pthread_cond_wait(&q->posted, &q->lock);
+    StreamBlock *block = q->items[q->head++ % q->capacity];
+    pthread_mutex_unlock(&q->lock);
+    return block;
+}
+
+void streamQueueFree(StreamQueue *q)
+{
+    pthread_cond_destroy(&q->posted);
+    pthread_mutex_destroy(&q->lock);
+    free(q->items);
+}
+
+// Keys order like the records: ints get their sign bit flipped, uint64 is its own key
+static inline void streamDecode(const unsigned char *src, uint64_t keys[], size_t n, int type)
+{
+    if (type == STREAM_INT32)
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t x;
+            memcpy(&x, src + 4 * i, 4);
+            keys[i] = x ^ 0x80000000u;
+        }
+    else
+        memcpy(keys, src, n * sizeof(uint64_t));
+}
+
+static inline void streamEncode(const uint64_t keys[], unsigned char *dst, size_t n, int type)
+{
+    if (type == STREAM_INT32)
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t x = (uint32_t)keys[i] ^ 0x80000000u;
+            memcpy(dst + 4 * i, &x, 4);
+        }
+    else
+        memcpy(dst, keys, n * sizeof(uint64_t));
+}
+
+typedef struct
+{
+    long long records;
+    int runs, spilled;
+    int mapped; // input read through mmap
+    double seconds, readSeconds, sortSeconds, spillSeconds, mergeSeconds, writeSeconds;
+} StreamReport;
+
+typedef struct
+{
+    int type;
+    size_t recordSize;
+    int inFd, outFd;
+    const unsigned char *map; // whole input when it is a regular file
+    size_t mapSize, mapPos;
+    unsigned char *staging; // read() buffer; stagingFill bytes not decoded yet
+    size_t stagingFill;
+    int eof, readError, writeError;
+    StreamQueue emptyChunks, fullChunks;
+    StreamQueue emptyBlocks, fullBlocks;
+    StreamReport *report;
+} StreamPipeline;
+
+// Decodes up to capacity records into keys; returns 0 at the end of the input. A read error
+// or a trailing partial record sets readError.
+size_t streamRead(StreamPipeline *sp, uint64_t keys[], size_t capacity)
+{
+    size_t size = sp->recordSize;
+    if (sp->map != NULL)
+    {
+        size_t n = (sp->mapSize - sp->mapPos) / size;
+        n = n < capacity ? n : capacity;
+        streamDecode(sp->map + sp->mapPos, keys, n, sp->type);
+        sp->mapPos += n * size;
+        if (n == 0 && sp->mapPos != sp->mapSize)
+            sp->readError = -1;
+        return n;
+    }
+
+    size_t total = 0;
+    while (total < capacity)
+    {
+        size_t whole = sp->stagingFill / size;
+        if (whole > 0)
+        {
+            size_t n = whole < capacity - total ? whole : capacity - total;
+            streamDecode(sp->staging, keys + total, n, sp->type);
+            total += n;
+            sp->stagingFill -= n * size;
+            memmove(sp->staging, sp->staging + n * size, sp->stagingFill);
+            continue;
+        }
+        if (sp->eof)
+            break;
+        ssize_t got = read(sp->inFd, sp->staging + sp->stagingFill, STREAM_READ_BYTES - sp->stagingFill);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+        {
+            sp->eof = 1;
+            if (got < 0 || sp->stagingFill != 0)
+                sp->readError = -1;
+        }
+        else
+            sp->stagingFill += got;
+    }
+    return total;
+}
+
+// Fills empty chunks until the input ends; an empty chunk then tells the sorter it is over
+void *streamReaderThread(void *arg)
+{
+    StreamPipeline *sp = (StreamPipeline *)arg;
+    for (;;)
+    {
+        StreamBlock *chunk = streamQueuePop(&sp->emptyChunks);
+        double start = wallTime();
+        size_t count = streamRead(sp, chunk->keys, chunk->count);
+        sp->report->readSeconds += wallTime() - start;
+        chunk->count = count;
+        streamQueuePush(&sp->fullChunks, chunk);
+        if (count == 0)
+            return NULL;
+    }
+}
+
+// Encodes and writes full blocks until an empty one arrives; failures set writeError but
+// keep draining so the merge never waits on a dead writer
+void *streamWriterThread(void *arg)
+{
+    StreamPipeline *sp = (StreamPipeline *)arg;
+    unsigned char *bytes = (unsigned char *)malloc(STREAM_BLOCK * sizeof(uint64_t));
+    for (;;)
+    {
+        StreamBlock *block = streamQueuePop(&sp->fullBlocks);
+        size_t count = block->count;
+        double start = wallTime();
+        streamEncode(block->keys, bytes, count, sp->type);
+        streamQueuePush(&sp->emptyBlocks, block);
+        size_t left = count * sp->recordSize, done = 0;
+        while (left > 0 && sp->writeError == 0)
+        {
+            ssize_t put = write(sp->outFd, bytes + done, left);
+            if (put < 0 && errno == EINTR)
+                continue;
+            if (put <= 0)
+                sp->writeError = -1;
+            else
+            {
+                done += put;
+                left -= put;
+            }
+        }
+        sp->report->writeSeconds += wallTime() - start;
+        if (count == 0)
+            break;
+    }
+    free(bytes);
+    return NULL;
+}
+
+typedef struct
+{
+    FILE *fp; // NULL for the run kept in memory
+    uint64_t *keys;
+    size_t count, pos, capacity;
+} StreamSource;
+
+// Merges the spilled runs and the in-memory run into output blocks for the writer
+int streamMerge(StreamPipeline *sp, char **names, int spilled, const StreamBlock *last, size_t bufferKeys)
+{
+    int k = spilled + (last->count > 0);
+    StreamSource *sources = (StreamSource *)calloc(k > 0 ? k : 1, sizeof(StreamSource));
+    uint64_t *key = (uint64_t *)malloc((k > 0 ? k : 1) * sizeof(uint64_t));
+    char *done = (char *)calloc(k > 0 ? k : 1, 1);
+    int status = 0;
+
+    for (int r = 0; r < k; r++)
+    {
+        StreamSource *s = &sources[r];
+        if (r == spilled)
+        {
+            s->keys = last->keys;
+            s->count = last->count;
+        }
+        else
+        {
+            s->fp = fopen(names[r], "rb");
+            s->capacity = bufferKeys;
+            s->keys = (uint64_t *)malloc(bufferKeys * sizeof(uint64_t));
+            if (s->fp == NULL)
+            {
+                fprintf(stderr, "Error opening run file %s.\n", names[r]);
+                done[r] = 1;
+                status = -1;
+                continue;
+            }
+            s->count = fread(s->keys, sizeof(uint64_t), bufferKeys, s->fp);
+        }
+        if (s->count == 0)
+            done[r] = 1;
+        else
+            key[r] = s->keys[0];
+    }
+
+    LoserTree64 lt;
+    loserTree64Init(&lt, k, key, done);
+    StreamBlock *block = streamQueuePop(&sp->emptyBlocks);
+    block->count = 0;
+    while (status == 0 && k > 0 && !done[lt.tree[0]])
+    {
+        int r = lt.tree[0];
+        StreamSource *s = &sources[r];
+        block->keys[block->count++] = key[r];
+        if (block->count == STREAM_BLOCK)
+        {
+            streamQueuePush(&sp->fullBlocks, block);
+            block = streamQueuePop(&sp->emptyBlocks);
+            block->count = 0;
+        }
+
+        if (++s->pos == s->count)
+        {
+            s->count = s->fp != NULL ? fread(s->keys, sizeof(uint64_t), s->capacity, s->fp) : 0;
+            s->pos = 0;
+        }
+        if (s->count == 0)
+            done[r] = 1;
+        else
+            key[r] = s->keys[s->pos];
+        loserTree64Replay(&lt);
+    }
+    if (block->count > 0)
+    {
+        streamQueuePush(&sp->fullBlocks, block);
+        block = streamQueuePop(&sp->emptyBlocks);
+    }
+    // The empty block ends the writer
+    block->count = 0;
+    streamQueuePush(&sp->fullBlocks, block);
+
+    for (int r = 0; r < spilled; r++)
+    {
+        if (sources[r].fp != NULL)
+            fclose(sources[r].fp);
+        free(sources[r].keys);
+    }
+    loserTree64Free(&lt);
+    free(done);
+    free(key);
+    free(sources);
+    return status;
+}
+
+// Sorts the records of input ("-" or NULL for stdin) into outFd. type is STREAM_INT32 or
+// STREAM_UINT64; report (may be NULL) receives counts and per-stage times. Returns 0 or -1.
+int streamSort(const char *input, int outFd, int type, size_t memoryBytes, const char *tmpDir, StreamReport *report)
+{
+    StreamReport local;
+    if (report == NULL)
+        report = &local;
+    memset(report, 0, sizeof(*report));
+    double begin = wallTime();
+
+    StreamPipeline sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.type = type;
+    sp.recordSize = type == STREAM_INT32 ? sizeof(int32_t) : sizeof(uint64_t);
+    sp.outFd = outFd;
+    sp.report = report;
+    sp.inFd = input == NULL || strcmp(input, "-") == 0 ? 0 : open(input, O_RDONLY);
+    if (sp.inFd < 0)
+    {
+        fprintf(stderr, "Error opening %s.\n", input);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(sp.inFd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, sp.inFd, 0);
+        if (map != MAP_FAILED)
+        {
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+            sp.map = (const unsigned char *)map;
+            sp.mapSize = st.st_size;
+            report->mapped = 1;
+        }
+    }
+    if (sp.map == NULL)
+        sp.staging = (unsigned char *)malloc(STREAM_READ_BYTES);
+
+    size_t chunkKeys = memoryBytes / 4 / sizeof(uint64_t);
+    chunkKeys = chunkKeys < STREAM_MIN_CHUNK ? STREAM_MIN_CHUNK : chunkKeys > INT_MAX ? INT_MAX : chunkKeys;
+    StreamBlock chunks[3], blocks[STREAM_OUTPUT_BLOCKS];
+    streamQueueInit(&sp.emptyChunks, 3);
+    streamQueueInit(&sp.fullChunks, 3);
+    // A chunk's pages are only touched once records arrive, so small inputs stay small
+    for (int c = 0; c < 3; c++)
+    {
+        chunks[c].keys = (uint64_t *)malloc(chunkKeys * sizeof(uint64_t));
+        chunks[c].count = chunkKeys;
+        streamQueuePush(&sp.emptyChunks, &chunks[c]);
+    }
+
+    pthread_t reader;
+    pthread_create(&reader, NULL, streamReaderThread, &sp);
+
+    // Sort every chunk; the previous one is spilled only once another chunk proves it is not
+    // the last
+    char **names = (char **)malloc(16 * sizeof(char *));
+    int nameCapacity = 16, status = 0;
+    StreamBlock *previous = NULL;
+    for (;;)
+    {
+        StreamBlock *chunk = streamQueuePop(&sp.fullChunks);
+        if (chunk->count == 0)
+        {
+            chunk->count = chunkKeys;
+            streamQueuePush(&sp.emptyChunks, chunk);
+            break;
+        }
+        report->records += chunk->count;
+        report->runs++;
+        double start = wallTime();
+        uint64RadixSort(chunk->keys, (int)chunk->count);
+        report->sortSeconds += wallTime() - start;
+        if (previous == NULL)
+        {
+            previous = chunk;
+            continue;
+        }
+
+        start = wallTime();
+        if (report->spilled == nameCapacity)
+        {
+            nameCapacity *= 2;
+            names = (char **)realloc(names, nameCapacity * sizeof(char *));
+        }
+        char *name = runFileName(tmpDir, 0, report->spilled);
+        names[report->spilled++] = name;
+        FILE *run = fopen(name, "wb");
+        if (run == NULL || fwrite(previous->keys, sizeof(uint64_t), previous->count, run) != previous->count ||
+            fclose(run) != 0)
+        {
+            fprintf(stderr, "Error writing run file %s.\n", name);
+            status = -1;
+        }
+        report->spillSeconds += wallTime() - start;
+        previous->count = chunkKeys;
+        streamQueuePush(&sp.emptyChunks, previous);
+        previous = chunk;
+        if (status != 0)
+        {
+            // Let the reader run to the end of the input, then stop
+            while ((chunk = streamQueuePop(&sp.fullChunks))->count != 0)
+            {
+                chunk->count = chunkKeys;
+                streamQueuePush(&sp.emptyChunks, chunk);
+            }
+            break;
+        }
+    }
+    pthread_join(reader, NULL);
+    if (sp.readError != 0)
+    {
+        fprintf(stderr, "Error reading %s: read failed or input is not a whole number of %s records.\n",
+                input == NULL ? "-" : input, streamTypeNames[type]);
+        status = -1;
+    }
+
+    if (status == 0)
+    {
+        // Chunks not holding the last run are no longer needed; their memory buffers the merge
+        size_t bufferKeys = STREAM_MIN_MERGE;
+        for (int c = 0; c < 3; c++)
+            if (&chunks[c] != previous)
+            {
+                free(chunks[c].keys);
+                chunks[c].keys = NULL;
+            }
+        if (report->spilled > 0 && 2 * chunkKeys / report->spilled > bufferKeys)
+            bufferKeys = 2 * chunkKeys / report->spilled;
+
+        StreamBlock none = {NULL, 0};
+        streamQueueInit(&sp.emptyBlocks, STREAM_OUTPUT_BLOCKS);
+        streamQueueInit(&sp.fullBlocks, STREAM_OUTPUT_BLOCKS);
+        for (int b = 0; b < STREAM_OUTPUT_BLOCKS; b++)
+        {
+            blocks[b].keys = (uint64_t *)malloc(STREAM_BLOCK * sizeof(uint64_t));
+            streamQueuePush(&sp.emptyBlocks, &blocks[b]);
+        }
+        pthread_t writer;
+        pthread_create(&writer, NULL, streamWriterThread, &sp);
+        double start = wallTime();
+        status = streamMerge(&sp, names, report->spilled, previous != NULL ? previous : &none, bufferKeys);
+        pthread_join(writer, NULL);
+        report->mergeSeconds = wallTime() - start;
+        if (sp.writeError != 0)
+        {
+            fprintf(stderr, "Error writing the sorted output.\n");
+            status = -1;
+        }
+        for (int b = 0; b < STREAM_OUTPUT_BLOCKS; b++)
+            free(blocks[b].keys);
+        streamQueueFree(&sp.emptyBlocks);
+        streamQueueFree(&sp.fullBlocks);
+    }
+
+    removeRunFiles(names, report->spilled);
+    for (int c = 0; c < 3; c++)
+        free(chunks[c].keys);
+    streamQueueFree(&sp.emptyChunks);
+    streamQueueFree(&sp.fullChunks);
+    free(sp.staging);
+    if (sp.map != NULL)
+        munmap((void *)sp.map, sp.mapSize);
+    if (sp.inFd != 0)
+        close(sp.inFd);
+    report->seconds = wallTime() - begin;
+    return status;
+}
+
+void printStreamReport(const StreamReport *r, int type)
+{
+    size_t size = type == STREAM_INT32 ? sizeof(int32_t) : sizeof(uint64_t);
+    fprintf(stderr, "Sorted %lld %s records in %.3f s: %.2f Mrecords/s, %.1f MB/s (%s input, %d runs, %d spilled)\n",
+            r->records, streamTypeNames[type], r->seconds, r->records / r->seconds / 1e6,
+            r->records * size / r->seconds / (1 << 20), r->mapped ? "mmap" : "read", r->runs, r->spilled);
+    fprintf(stderr, "  read %.3f s, sort %.3f s, spill %.3f s, merge %.3f s, write %.3f s (stages overlap)\n",
+            r->readSeconds, r->sortSeconds, r->spillSeconds, r->mergeSeconds, r->writeSeconds);
+}
+
+// Radix benchmark: base-10 vs LSD digit widths vs introsort
+double timeIntSort(void (*sortFunc)(int[], int), int src[], int dest[], int n)
+{
+    copyArray(src, dest, n);
+    double start = wallTime();
+    sortFunc(dest, n);
+    double elapsed = wallTime() - start;
+    if (!isSorted(dest, n))
+        printf("Warning: output not sorted (n = %d)\n", n);
+    return elapsed;
+}
+
+void radixSort8(int arr[], int n) { radixSortBits(arr, n, 8); }
+void radixSort11(int arr[], int n) { radixSortBits(arr, n, 11); }
+void radixSort16(int arr[], int n) { radixSortBits(arr, n, 16); }
+
+void benchmarkRadix(int maxN)
+{
+    FILE *fp = fopen("radix_sorting_times.dat", "w");
+    fprintf(fp, "# n base10_mod1000 lsd8_mod1000 lsd11_mod1000 lsd16_mod1000 intro_mod1000 "
+                "lsd8_signed lsd11_signed lsd16_signed intro_signed lsd_u64 lsd_pairs\n");
+
+    int *narrow = (int *)malloc(maxN * sizeof(int));
+    int *wide = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+    int *values = (int *)malloc(maxN * sizeof(int));
+    uint64_t *keys64 = (uint64_t *)malloc(maxN * sizeof(uint64_t));
+
+    for (int i = 0; i < maxN; i++)
+    {
+        narrow[i] = (int)(randomU64() % 1000);
+        wide[i] = (int)(uint32_t)randomU64();
+    }
+
+    printf("%10s %9s %9s %9s %9s %9s | %9s %9s %9s %9s | %9s %9s\n", "n", "base10", "lsd8", "lsd11", "lsd16",
+           "intro", "lsd8", "lsd11", "lsd16", "intro", "u64", "pairs");
+    for (int n = 10000; n <= maxN; n *= 10)
+    {
+        // countingSort keeps a VLA of n ints on the stack per pass
+        double base10 = n <= 1000000 ? timeIntSort(radixSortBase10, narrow, temp, n) : NAN;
+        double narrow8 = timeIntSort(radixSort8, narrow, temp, n);
+        double narrow11 = timeIntSort(radixSort11, narrow, temp, n);
+        double narrow16 = timeIntSort(radixSort16, narrow, temp, n);
+        double narrowIntro = timeIntSort(introSort, narrow, temp, n);
+        double wide8 = timeIntSort(radixSort8, wide, temp, n);
+        double wide11 = timeIntSort(radixSort11, wide, temp, n);
+        double wide16 = timeIntSort(radixSort16, wide, temp, n);
+        double wideIntro = timeIntSort(introSort, wide, temp, n);
+
+        for (int i = 0; i < n; i++)
+            keys64[i] = randomU64();
+        double start = wallTime();
+        radixSortU64(keys64, n);
+        double u64Time = wallTime() - start;
+
+        copyArray(wide, temp, n);
+        for (int i = 0; i < n; i++)
+            values[i] = i;
+        start = wallTime();
+        radixSortPairs(temp, values, n);
+        double pairsTime = wallTime() - start;
+
+        printf("%10d %9.5f %9.5f %9.5f %9.5f %9.5f | %9.5f %9.5f %9.5f %9.5f | %9.5f %9.5f\n", n, base10, narrow8,
+               narrow11, narrow16, narrowIntro, wide8, wide11, wide16, wideIntro, u64Time, pairsTime);
+        fprintf(fp, "%d %f %f %f %f %f %f %f %f %f %f %f\n", n, base10, narrow8, narrow11, narrow16, narrowIntro,
+                wide8, wide11, wide16, wideIntro, u64Time, pairsTime);
+        if (n > maxN / 10)
+            break;
+    }
+
+    fclose(fp);
+    free(narrow);
+    free(wide);
+    free(temp);
+    free(values);
+    free(keys64);
+    printf("Data saved to radix_sorting_times.dat\n");
+}
+
+// Parallel radix scaling: 1..N threads, keys/s and GB/s of key data sorted
+void benchmarkParallelRadix(int n, int maxThreads)
+{
+    int *keys = (int *)malloc(n * sizeof(int));
+    int *temp = (int *)malloc(n * sizeof(int));
+    uint64_t *keys64 = (uint64_t *)malloc(n * sizeof(uint64_t));
+    uint64_t *temp64 = (uint64_t *)malloc(n * sizeof(uint64_t));
+
+    for (int i = 0; i < n; i++)
+    {
+        keys[i] = (int)(uint32_t)randomU64();
+        keys64[i] = randomU64();
+    }
+
+    FILE *fp = fopen("parallel_radix_times.dat", "w");
+    fprintf(fp, "# threads lsd32_seconds lsd32_mkeys lsd32_gbs msd64_seconds msd64_mkeys msd64_gbs\n");
+    printf("n = %d, threads up to %d\n", n, maxThreads);
+    printf("%8s %12s %10s %8s %12s %10s %8s\n", "threads", "lsd32 (s)", "Mkeys/s", "GB/s", "msd64 (s)", "Mkeys/s",
+           "GB/s");
+
+    for (int threads = 1;; threads *= 2)
+    {
+        if (threads > maxThreads)
+            threads = maxThreads;
+
+        copyArray(keys, temp, n);
+        double start = wallTime();
+        parallelRadixSort(temp, n, threads);
+        double t32 = wallTime() - start;
+        if (!isSorted(temp, n))
+            printf("Warning: parallel radix output not sorted\n");
+
+        memcpy(temp64, keys64, n * sizeof(uint64_t));
+        start = wallTime();
+        parallelRadixSortU64(temp64, n, threads);
+        double t64 = wallTime() - start;
+        for (int i = 1; i < n; i++)
+            if (temp64[i - 1] > temp64[i])
+            {
+                printf("Warning: parallel MSD output not sorted\n");
+                break;
+            }
+
+        double mkeys32 = n / t32 / 1e6, gbs32 = n * sizeof(int) / t32 / 1e9;
+        double mkeys64 = n / t64 / 1e6, gbs64 = n * sizeof(uint64_t) / t64 / 1e9;
+        printf("%8d %12.5f %10.1f %8.3f %12.5f %10.1f %8.3f\n", threads, t32, mkeys32, gbs32, t64, mkeys64, gbs64);
+        fprintf(fp, "%d %f %f %f %f %f %f\n", threads, t32, mkeys32, gbs32, t64, mkeys64, gbs64);
+        if (threads == maxThreads)
+            break;
+    }
+
+    fclose(fp);
+    free(keys);
+    free(temp);
+    free(keys64);
+    free(temp64);
+    printf("Data saved to parallel_radix_times.dat\n");
+}
+
+// SIMD small-array benchmark: nanoseconds per element for insertionSort vs simdSort at every level
+void benchmarkSIMD(void)
+{
+    int sizes[] = {8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+    int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+    int maxSize = sizes[numSizes - 1];
+    int detected = simdLevel();
+    const int totalElements = 4000000;
+
+    int *src = (int *)malloc(totalElements * sizeof(int));
+    int *temp = (int *)malloc(maxSize * sizeof(int));
+    for (int i = 0; i < totalElements; i++)
+        src[i] = (int)(uint32_t)randomU64();
+
+    FILE *fp = fopen("simd_sorting_times.dat", "w");
+    fprintf(fp, "# n insertion_ns scalar_ns sse41_ns avx2_ns (ns per element, nan = unsupported)\n");
+    printf("Detected SIMD level: %s\n", simdLevelNames[detected]);
+    printf("%6s %12s %12s %12s %12s\n", "n", "insertion", "scalar", "sse4.1", "avx2");
+
+    for (int s = 0; s < numSizes; s++)
+    {
+        int n = sizes[s];
+        int reps = totalElements / n;
+        double ns[4];
+
+        for (int variant = 0; variant < 4; variant++)
+        {
+            int level = variant - 1;
+            if (level > detected)
+            {
+                ns[variant] = NAN;
+                continue;
+            }
+            simdLevelOverride = level;
+            double start = wallTime();
+            for (int r = 0; r < reps; r++)
+            {
+                memcpy(temp, src + (size_t)r * n, n * sizeof(int));
+                if (variant == 0)
+                    insertionSort(temp, n);
+                else
+                    simdSort(temp, n);
+            }
+            ns[variant] = (wallTime() - start) * 1e9 / ((double)reps * n);
+            if (!isSorted(temp, n))
+                printf("Warning: output not sorted (n = %d)\n", n);
+        }
+        simdLevelOverride = -1;
+
+        printf("%6d %12.2f %12.2f %12.2f %12.2f\n", n, ns[0], ns[1], ns[2], ns[3]);
+        fprintf(fp, "%d %f %f %f %f\n", n, ns[0], ns[1], ns[2], ns[3]);
+    }
+
+    fclose(fp);
+    free(src);
+    free(temp);
+    printf("Data saved to simd_sorting_times.dat\n");
+}
+
+// pdqsort benchmark: time, branch misses and IPC against quickSort and introSort
+
+void benchmarkPDQ(int maxN)
+{
+    const char *patterns[] = {"random", "mod1000", "sorted", "reversed", "equal", "sawtooth", "organpipe"};
+    int numPatterns = sizeof(patterns) / sizeof(patterns[0]);
+    const char *names[] = {"quickSort", "introSort", "pdqSort"};
+    void (*sorts[])(int[], int) = {quickSortRange, introSort, pdqSort};
+
+    int *src = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+    PerfCounters pc;
+    perfOpen(&pc);
+    if (!perfAvailable(&pc, PERF_CYCLES))
+        printf("Hardware counters unavailable; reporting time only.\n");
+
+    FILE *fp = fopen("pdq_sorting_times.dat", "w");
+    fprintf(fp, "# pattern n algorithm seconds branch_misses ipc\n");
+    printf("%-10s %10s %-10s %10s %14s %6s\n", "pattern", "n", "algorithm", "seconds", "branch-misses", "IPC");
+
+    for (int p = 0; p < numPatterns; p++)
+    {
+        for (int n = 100000; n <= maxN; n *= 10)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                switch (p)
+                {
+                case 0: src[i] = (int)(uint32_t)randomU64(); break;
+                case 1: src[i] = (int)(randomU64() % 1000); break;
+                case 2: src[i] = i; break;
+                case 3: src[i] = n - i; break;
+                case 4: src[i] = 42; break;
+                case 5: src[i] = i % 1000; break;
+                default: src[i] = i < n / 2 ? i : n - i; break;
+                }
+            }
+
+            for (int a = 0; a < 3; a++)
+            {
+                // Lomuto quickSort degrades to O(n^2) time and O(n) stack on these patterns
+                if (a == 0 && p >= 2)
+                    continue;
+
+                copyArray(src, temp, n);
+                perfStart(&pc);
+                double start = wallTime();
+                sorts[a](temp, n);
+                double elapsed = wallTime() - start;
+                perfStop(&pc);
+                if (!isSorted(temp, n))
+                    printf("Warning: %s output not sorted\n", names[a]);
+
+                double misses = perfValue(&pc, PERF_BRANCH_MISSES);
+                double ipc = perfValue(&pc, PERF_INSTRUCTIONS) / perfValue(&pc, PERF_CYCLES);
+                printf("%-10s %10d %-10s %10.5f %14.0f %6.2f\n", patterns[p], n, names[a], elapsed, misses, ipc);
+                fprintf(fp, "%s %d %s %f %.0f %f\n", patterns[p], n, names[a], elapsed, misses, ipc);
+            }
+            if (n > maxN / 10)
+                break;
+        }
+    }
+
+    perfClose(&pc);
+    fclose(fp);
+    free(src);
+    free(temp);
+    printf("Data saved to pdq_sorting_times.dat\n");
+}
+
+// Generic sorts per element type against qsort with a comparator function
+int compareInt64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+int compareUint64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Floats compare by their total-order keys, so qsort is defined for NaN and -0.0 too
+int compareFloat(const void *a, const void *b)
+{
+    uint32_t x = floatKey(*(const float *)a), y = floatKey(*(const float *)b);
+    return (x > y) - (x < y);
+}
+
+int compareDouble(const void *a, const void *b)
+{
+    uint64_t x = doubleKey(*(const double *)a), y = doubleKey(*(const double *)b);
+    return (x > y) - (x < y);
+}
+
+int compareRecord(const void *a, const void *b)
+{
+    uint64_t x = ((const Record *)a)->key, y = ((const Record *)b)->key;
+    return (x > y) - (x < y);
+}
+
+int compareKeyValue(const void *a, const void *b)
+{
+    uint32_t x = ((const KeyValue *)a)->key, y = ((const KeyValue *)b)->key;
+    return (x > y) - (x < y);
+}
+
+typedef struct
+{
+    const char *name;
+    size_t size;
+    int (*compare)(const void *, const void *);
+    void (*introSort)(void *, int);
+    void (*mergeSort)(void *, int);
+    void (*radixSort)(void *, int);
+} GenericType;
+
+#define GENERIC_TYPE(label, name, T, compare)                                                  \
+    {                                                                                          \
+        label, sizeof(T), compare, (void (*)(void *, int))name##IntroSort,                     \
+            (void (*)(void *, int))name##MergeSort, (void (*)(void *, int))name##RadixSort     \
+    }
+
+void fillGeneric(const char *type, void *data, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        uint64_t r = randomU64();
+        if (strcmp(type, "int64") == 0)
+            ((int64_t *)data)[i] = (int64_t)r;
+        else if (strcmp(type, "uint64") == 0)
+            ((uint64_t *)data)[i] = r;
+        else if (strcmp(type, "float") == 0)
+            ((float *)data)[i] = (float)((int64_t)r >> 11) / 1e9f;
+        else if (strcmp(type, "double") == 0)
+            ((double *)data)[i] = (double)((int64_t)r >> 11) / 1e9;
+        else if (strcmp(type, "record") == 0)
+        {
+            ((Record *)data)[i].key = r;
+            memset(((Record *)data)[i].payload, i & 0x7F, sizeof(((Record *)data)[i].payload));
+        }
+        else
+        {
+            ((KeyValue *)data)[i].key = (uint32_t)r;
+            ((KeyValue *)data)[i].value = i;
+        }
+    }
+}
+
+void benchmarkGeneric(int n)
+{
+    GenericType types[] = {
+        GENERIC_TYPE("int64", int64, int64_t, compareInt64),
+        GENERIC_TYPE("uint64", uint64, uint64_t, compareUint64),
+        GENERIC_TYPE("float", float, float, compareFloat),
+        GENERIC_TYPE("double", double, double, compareDouble),
+        GENERIC_TYPE("record", record, Record, compareRecord),
+        GENERIC_TYPE("keyvalue", keyValue, KeyValue, compareKeyValue),
+    };
+    int numTypes = sizeof(types) / sizeof(types[0]);
+
+    FILE *fp = fopen("generic_sorting_times.dat", "w");
+    fprintf(fp, "# type n qsort intro merge radix\n");
+    printf("n = %d\n%-10s %10s %10s %10s %10s\n", n, "type", "qsort", "intro", "merge", "radix");
+
+    for (int t = 0; t < numTypes; t++)
+    {
+        GenericType *g = &types[t];
+        char *src = (char *)malloc((size_t)n * g->size);
+        char *temp = (char *)malloc((size_t)n * g->size);
+        char *expected = (char *)malloc((size_t)n * g->size);
+        fillGeneric(g->name, src, n);
+
+        double times[4];
+        for (int a = 0; a < 4; a++)
+        {
+            memcpy(temp, src, (size_t)n * g->size);
+            double start = wallTime();
+            if (a == 0)
+                qsort(temp, n, g->size, g->compare);
+            else if (a == 1)
+                g->introSort(temp, n);
+            else if (a == 2)
+                g->mergeSort(temp, n);
+            else
+                g->radixSort(temp, n);
+            times[a] = wallTime() - start;
+
+            if (a == 0)
+                memcpy(expected, temp, (size_t)n * g->size);
+            else
+                for (int i = 0; i < n; i++)
+                    if (g->compare(temp + (size_t)i * g->size, expected + (size_t)i * g->size) != 0)
+                    {
+                        printf("Warning: %s sort %d disagrees with qsort\n", g->name, a);
+                        break;
+                    }
+        }
+
+        printf("%-10s %10.5f %10.5f %10.5f %10.5f\n", g->name, times[0], times[1], times[2], times[3]);
+        fprintf(fp, "%s %d %f %f %f %f\n", g->name, n, times[0], times[1], times[2], times[3]);
+        free(src);
+        free(temp);
+        free(expected);
+    }
+
+    fclose(fp);
+    printf("Data saved to generic_sorting_times.dat\n");
+}
+
+// External sort throughput over file sizes and memory budgets on the local disk
+int verifySortedFile(const char *path, long long expectedInts)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+        return 0;
+    int *buffer = (int *)malloc(EXTERNAL_MIN_BUFFER);
+    long long total = 0;
+    int previous = INT_MIN, sorted = 1;
+    size_t n;
+    while ((n = fread(buffer, sizeof(int), EXTERNAL_MIN_BUFFER / sizeof(int), fp)) > 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            if (buffer[i] < previous)
+                sorted = 0;
+            previous = buffer[i];
+        }
+        total += n;
+    }
+    fclose(fp);
+    free(buffer);
+    return sorted && total == expectedInts;
+}
+
+void benchmarkExternal(int maxFileMB, const char *tmpDir)
+{
+    int budgetsMB[] = {8, 32, 128};
+    int numBudgets = sizeof(budgetsMB) / sizeof(budgetsMB[0]);
+    char input[1024], output[1024];
+    snprintf(input, sizeof(input), "%s/external_bench_input.bin", tmpDir);
+    snprintf(output, sizeof(output), "%s/external_bench_output.bin", tmpDir);
+
+    FILE *fp = fopen("external_sort_times.dat", "w");
+    fprintf(fp, "# file_mb budget_mb runs seconds mb_per_s\n");
+    printf("%8s %10s %6s %10s %10s\n", "file MB", "budget MB", "runs", "seconds", "MB/s");
+
+    int *block = (int *)malloc(EXTERNAL_MIN_BUFFER);
+    for (int fileMB = 16; fileMB <= maxFileMB; fileMB *= 4)
+    {
+        FILE *in = fopen(input, "wb");
+        if (in == NULL)
+        {
+            printf("Error opening %s.\n", input);
+            break;
+        }
+        long long ints = (long long)fileMB * (1 << 20) / sizeof(int);
+        for (long long written = 0; written < ints; written += EXTERNAL_MIN_BUFFER / sizeof(int))
+        {
+            for (size_t i = 0; i < EXTERNAL_MIN_BUFFER / sizeof(int); i++)
+                block[i] = (int)(uint32_t)randomU64();
+            fwrite(block, 1, EXTERNAL_MIN_BUFFER, in);
+        }
+        fclose(in);
+
+        for (int b = 0; b < numBudgets; b++)
+        {
+            if (budgetsMB[b] > 2 * fileMB)
+                continue;
+            double start = wallTime();
+            int runs = externalSort(input, output, (size_t)budgetsMB[b] << 20, tmpDir);
+            double elapsed = wallTime() - start;
+            if (runs < 0 || !verifySortedFile(output, ints))
+                printf("Warning: external sort failed or output not sorted\n");
+
+            printf("%8d %10d %6d %10.3f %10.1f\n", fileMB, budgetsMB[b], runs, elapsed, fileMB / elapsed);
+            fprintf(fp, "%d %d %d %f %f\n", fileMB, budgetsMB[b], runs, elapsed, fileMB / elapsed);
+        }
+    }
+
+    remove(input);
+    remove(output);
+    free(block);
+    fclose(fp);
+    printf("Data saved to external_sort_times.dat\n");
+}
+
+// Distributed sort scaling: 1..maxWorkers worker processes on a random and a few-unique file of
+// n ints, one gnuplot data block per distribution. Every run's range files are checked: each
+// sorted, ranges ascending from file to file, no key lost.
+void benchmarkDistributed(int n, int maxWorkers, const char *tmpDir)
+{
+    int dists[] = {DIST_RANDOM, DIST_FEW_UNIQUE};
+    int numDists = sizeof(dists) / sizeof(dists[0]);
+    char input[1024], prefix[1024];
+    snprintf(input, sizeof(input), "%s/distributed_bench_input.bin", tmpDir);
+    snprintf(prefix, sizeof(prefix), "%s/distributed_bench_output", tmpDir);
+    if (maxWorkers < 1)
+        maxWorkers = 1;
+    if (maxWorkers > DISTRIBUTED_MAX_WORKERS)
+        maxWorkers = DISTRIBUTED_MAX_WORKERS;
+
+    int *keys = (int *)malloc(n * sizeof(int));
+    WorkerReport *reports = (WorkerReport *)malloc(maxWorkers * sizeof(WorkerReport));
+    FILE *fp = fopen("distributed_times.dat", "w");
+    fprintf(fp, "# workers seconds mkeys_per_s mb_per_s imbalance\n");
+
+    for (int d = 0; d < numDists; d++)
+    {
+        fillDistribution(keys, n, dists[d]);
+        FILE *in = fopen(input, "wb");
+        if (in == NULL || fwrite(keys, sizeof(int), n, in) != (size_t)n || fclose(in) != 0)
+        {
+            printf("Error writing %s.\n", input);
+            break;
+        }
+        fprintf(fp, "%s# %s\n", d > 0 ? "\n\n" : "", distributionNames[dists[d]]);
+
+        for (int workers = 1;; workers *= 2)
+        {
+            if (workers > maxWorkers)
+                workers = maxWorkers;
+            printf("\n%s, n = %d, %d workers\n", distributionNames[dists[d]], n, workers);
+            double start = wallTime();
+            int status = distributedSort(input, prefix, workers, reports);
+            double elapsed = wallTime() - start;
+
+            if (status == 0)
+            {
+                double imbalance = printDistributedReport(reports, workers, elapsed);
+                long long total = 0;
+                int ok = 1, previousMax = INT_MIN;
+                for (int w = 0; w < workers; w++)
+                {
+                    char *name = rangeFileName(prefix, w);
+                    ok &= verifySortedFile(name, reports[w].count);
+                    if (reports[w].count > 0)
+                    {
+                        ok &= reports[w].min >= previousMax;
+                        previousMax = reports[w].max;
+                    }
+                    total += reports[w].count;
+                    remove(name);
+                    free(name);
+                }
+                if (!ok || total != n)
+                    printf("Warning: range files are not a sorted partition of the input\n");
+                fprintf(fp, "%d %f %f %f %f\n", workers, elapsed, n / elapsed / 1e6,
+                        n * sizeof(int) / elapsed / (1 << 20), imbalance);
+            }
+            else
+                printf("Warning: distributed sort failed\n");
+            if (workers == maxWorkers)
+                break;
+        }
+    }
+
+    remove(input);
+    fclose(fp);
+    free(reports);
+    free(keys);
+    printf("Data saved to distributed_times.dat\n");
+}
+
+// Adaptive sort calibration and evaluation
+// Best-of-reps time for one call, repeating small inputs so each sample is long enough to measure
+double timeSortCall(void (*sortFunc)(int[], int), const int src[], int temp[], int n)
+{
+    int calls = n < 100000 ? 100000 / (n > 0 ? n : 1) : 1;
+    double best = INFINITY;
+    for (int rep = 0; rep < 3; rep++)
+    {
+        double elapsed = 0.0;
+        for (int c = 0; c < calls; c++)
+        {
+            memcpy(temp, src, n * sizeof(int));
+            double start = wallTime();
+            sortFunc(temp, n);
+            elapsed += wallTime() - start;
+        }
+        if (elapsed / calls < best)
+            best = elapsed / calls;
+    }
+    return best;
+}
+
+// The insertion attempt as autoSortChoice makes it, finished by pdqSort when the budget runs out
+void budgetedInsertionTrial(int arr[], int n)
+{
+    if (n > 1 && !budgetedInsertionSort(arr, n, 1, 2L * n))
+        pdqSort(arr, n);
+}
+
+void tuneAutoSort(const char *path)
+{
+    AutoSortConfig cfg = autoConfig;
+    int maxN = 1 << 20;
+    int *src = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+
+    // Largest size where insertion sort still beats pdqSort
+    int smallSizes[] = {8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256};
+    cfg.insertionMaxN = 0;
+    for (int s = 0; s < (int)(sizeof(smallSizes) / sizeof(smallSizes[0])); s++)
+    {
+        int n = smallSizes[s];
+        fillDistribution(src, n, DIST_RANDOM);
+        double insertion = timeSortCall(insertionSort, src, temp, n);
+        double pdq = timeSortCall(pdqSort, src, temp, n);
+        printf("n = %6d insertion %.3g s pdq %.3g s\n", n, insertion, pdq);
+        if (insertion > pdq)
+            break;
+        cfg.insertionMaxN = n;
+    }
+
+    // Largest size where the budgeted insertion sort on nearly sorted input (one swap per 100, at
+    // least one) beats the alternatives auto would otherwise pick there
+    int mediumSizes[] = {32, 64, 128, 256, 512, 1024, 2048};
+    int numMedium = sizeof(mediumSizes) / sizeof(mediumSizes[0]);
+    cfg.presortedInsertionMaxN = cfg.insertionMaxN;
+    for (int s = 0; s < numMedium; s++)
+    {
+        int n = mediumSizes[s];
+        for (int i = 0; i < n; i++)
+            src[i] = i;
+        for (int k = 0; k < (n / 100 > 1 ? n / 100 : 1); k++)
+        {
+            int a = (int)(randomU64() % n), b = (int)(randomU64() % n);
+            int t = src[a];
+            src[a] = src[b];
+            src[b] = t;
+        }
+        double insertion = timeSortCall(budgetedInsertionTrial, src, temp, n);
+        double natural = timeSortCall(naturalMergeSort, src, temp, n);
+        double counting = timeSortCall(boundedCountingSort, src, temp, n);
+        double pdq = timeSortCall(pdqSort, src, temp, n);
+        printf("n = %6d nearly sorted: insertion %.3g s natural merge %.3g s counting %.3g s pdq %.3g s\n", n,
+               insertion, natural, counting, pdq);
+        if (insertion > natural || insertion > counting || insertion > pdq)
+            break;
+        cfg.presortedInsertionMaxN = n;
+    }
+
+    // Largest size where intro sort still beats pdqSort on random keys
+    cfg.introMaxN = 0;
+    for (int s = 0; s < numMedium; s++)
+    {
+        int n = mediumSizes[s];
+        fillDistribution(src, n, DIST_RANDOM);
+        double intro = timeSortCall(introSort, src, temp, n);
+        double pdq = timeSortCall(pdqSort, src, temp, n);
+        printf("n = %6d intro %.3g s pdq %.3g s\n", n, intro, pdq);
+        if (intro > pdq)
+            break;
+        cfg.introMaxN = n;
+    }
+
+    // Smallest size where radix sort beats pdqSort on full-width keys
+    cfg.radixMinN = INT_MAX;
+    for (int n = 256; n <= maxN; n *= 2)
+    {
+        fillDistribution(src, n, DIST_RANDOM);
+        double radix = timeSortCall(radixSort, src, temp, n);
+        double pdq = timeSortCall(pdqSort, src, temp, n);
+        printf("n = %7d radix %.3g s pdq %.3g s\n", n, radix, pdq);
+        if (radix < pdq)
+        {
+            cfg.radixMinN = n;
+            break;
+        }
+    }
+
+    // Below radixMinN: the widest key range (relative to n) where radix still wins
+    int narrowN = cfg.radixMinN == INT_MAX ? 65536 : (cfg.radixMinN / 4 > 1024 ? cfg.radixMinN / 4 : 1024);
+    cfg.narrowRangeFactor = 0.0;
+    for (double factor = 1.0 / 64; factor <= 64; factor *= 2)
+    {
+        long long range = (long long)(factor * narrowN) > 1 ? (long long)(factor * narrowN) : 1;
+        for (int i = 0; i < narrowN; i++)
+            src[i] = (int)(randomU64() % range);
+        double radix = timeSortCall(radixSort, src, temp, narrowN);
+        double pdq = timeSortCall(pdqSort, src, temp, narrowN);
+        printf("range = %g n: radix %.3g s pdq %.3g s\n", factor, radix, pdq);
+        if (radix >= pdq)
+            break;
+        cfg.narrowRangeFactor = factor;
+    }
+
+    // Widest key range (relative to n) where counting sort beats the other choices
+    cfg.countingRangeFactor = 0.0;
+    for (double factor = 1.0 / 64; factor <= 256; factor *= 2)
+    {
+        int countN = 100000;
+        long long range = (long long)(factor * countN) > 1 ? (long long)(factor * countN) : 1;
+        for (int i = 0; i < countN; i++)
+            src[i] = (int)(randomU64() % range);
+        double counting = timeSortCall(boundedCountingSort, src, temp, countN);
+        double radix = timeSortCall(radixSort, src, temp, countN);
+        double pdq = timeSortCall(pdqSort, src, temp, countN);
+        printf("range = %g n: counting %.3g s radix %.3g s pdq %.3g s\n", factor, counting, radix, pdq);
+        if (counting >= radix || counting >= pdq)
+            break;
+        cfg.countingRangeFactor = factor;
+    }
+
+    // Highest estimated run ratio where merging existing runs beats the general choice
+    int n = 100000;
+    cfg.nearlySortedRuns = 0.0;
+    double swapFractions[] = {0.0005, 0.001, 0.003, 0.01, 0.03, 0.1, 0.3};
+    for (int f = 0; f < (int)(sizeof(swapFractions) / sizeof(swapFractions[0])); f++)
+    {
+        for (int i = 0; i < n; i++)
+            src[i] = i;
+        for (int k = 0; k < (int)(swapFractions[f] * n); k++)
+        {
+            int a = (int)(randomU64() % n), b = (int)(randomU64() % n);
+            int t = src[a];
+            src[a] = src[b];
+            src[b] = t;
+        }
+        double runRatio = estimateRunRatio(src, n);
+        double natural = timeSortCall(naturalMergeSort, src, temp, n);
+        double general = timeSortCall(n >= cfg.radixMinN ? radixSort : pdqSort, src, temp, n);
+        printf("runs/n %.4f: natural merge %.3g s general %.3g s\n", runRatio, natural, general);
+        if (natural >= general)
+            break;
+        cfg.nearlySortedRuns = runRatio;
+    }
+
+    free(src);
+    free(temp);
+    if (saveAutoConfig(path, &cfg) == 0)
+    {
+        autoConfig = cfg;
+        autoConfigLoaded = 1;
+        printf("insertion_max_n = %d, presorted_insertion_max_n = %d, intro_max_n = %d, nearly_sorted_runs = %g, "
+               "counting_range_factor = %g, narrow_range_factor = %g, radix_min_n = %d\n",
+               cfg.insertionMaxN, cfg.presortedInsertionMaxN, cfg.introMaxN, cfg.nearlySortedRuns,
+               cfg.countingRangeFactor, cfg.narrowRangeFactor, cfg.radixMinN);
+        printf("Thresholds saved to %s\n", path);
+    }
+}
+
+// Auto mode against every fixed choice over the distribution suite. A case fails when auto's output
+// is not sorted, or when auto stays slower than the best fixed choice by more than
+// AUTO_BENCH_TOLERANCE after AUTO_BENCH_RETRIES re-timings of both; returns the number of failures.
+#define AUTO_BENCH_TOLERANCE 0.25
+#define AUTO_BENCH_RETRIES 4
+
+int benchmarkAuto(int maxN)
+{
+    const char *names[] = {"Insertion Sort", "Natural Merge Sort", "Counting Sort", "Radix Sort",
+                           "PDQ Sort",       "Intro Sort",         "Merge Sort"};
+    void (*sorts[])(int[], int) = {insertionSort, naturalMergeSort, boundedCountingSort, radixSort,
+                                   pdqSort,       introSort,        mergeSortRange};
+    int numFixed = sizeof(sorts) / sizeof(sorts[0]);
+
+    if (!autoConfigLoaded)
+        loadAutoConfig(AUTO_CONFIG_FILE);
+    int *src = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+
+    FILE *fp = fopen("auto_sorting_times.dat", "w");
+    if (src == NULL || temp == NULL || fp == NULL)
+    {
+        printf("Error allocating benchmark buffers or opening auto_sorting_times.dat.\n");
+        free(src);
+        free(temp);
+        if (fp != NULL)
+            fclose(fp);
+        return -1;
+    }
+    fprintf(fp, "# distribution n best_fixed best_fixed_seconds auto_choice auto_seconds ratio\n");
+    printf("%-14s %8s %-20s %11s %-20s %11s %6s\n", "distribution", "n", "best fixed", "seconds", "auto choice",
+           "seconds", "ratio");
+
+    int failures = 0;
+    for (int n = 100; n <= maxN; n *= 100)
+    {
+        for (int d = 0; d < DIST_COUNT; d++)
+        {
+            fillDistribution(src, n, d);
+            int best = -1;
+            double bestTime = INFINITY;
+            for (int a = 0; a < numFixed; a++)
+            {
+                if (tooLargeFor(sorts[a], n))
+                    continue;
+                double t = timeSortCall(sorts[a], src, temp, n);
+                if (t < bestTime)
+                {
+                    bestTime = t;
+                    best = a;
+                }
+            }
+
+            copyArray(src, temp, n);
+            int choice = autoSortChoice(temp, n);
+            int unsorted = !isSorted(temp, n);
+            if (unsorted)
+                printf("Error: auto sort output not sorted\n");
+            double autoTime = timeSortCall(autoSort, src, temp, n);
+
+            // Timer noise on short runs: re-time both before calling it a miss, keeping the best of each
+            for (int r = 0; r < AUTO_BENCH_RETRIES && autoTime > (1 + AUTO_BENCH_TOLERANCE) * bestTime; r++)
+            {
+                double t = timeSortCall(sorts[best], src, temp, n);
+                bestTime = t < bestTime ? t : bestTime;
+                t = timeSortCall(autoSort, src, temp, n);
+                autoTime = t < autoTime ? t : autoTime;
+            }
+            int failed = unsorted || autoTime > (1 + AUTO_BENCH_TOLERANCE) * bestTime;
+            failures += failed;
+
+            printf("%-14s %8d %-20s %11.3g %-20s %11.3g %6.2f%s\n", distributionNames[d], n, names[best], bestTime,
+                   autoChoiceNames[choice], autoTime, autoTime / bestTime, failed ? " FAIL" : "");
+            fprintf(fp, "%s %d \"%s\" %g \"%s\" %g %f\n", distributionNames[d], n, names[best], bestTime,
+                    autoChoiceNames[choice], autoTime, autoTime / bestTime);
+        }
+        if (n > maxN / 100)
+            break;
+    }
+
+    fclose(fp);
+    free(src);
+    free(temp);
+    printf("Data saved to auto_sorting_times.dat\n");
+    if (failures > 0)
+        printf("%d case(s) where auto is more than %.0f%% slower than the best fixed choice\n", failures,
+               AUTO_BENCH_TOLERANCE * 100);
+    return failures;
+}
+
+// Counting sort on the data sets the existing drivers use: rand() % 1000 (SortAlgoApplication.c)
+// and normally distributed values around 50 (SortAlogsv2.c)
+// boundedCountingSort held to one thread, for the serial column
+void countingSortSerial(int arr[], int n)
+{
+    if (!countingSortRange(arr, n, 1))
+        radixSort(arr, n);
+}
+
+void benchmarkCounting(int maxN)
+{
+    const char *dataSets[] = {"mod1000", "normal"};
+    const char *names[] = {"counting", "counting_1t", "radix", "pdq", "merge", "auto"};
+    void (*sorts[])(int[], int) = {boundedCountingSort, countingSortSerial, radixSort,
+                                   pdqSort,             mergeSortRange,     autoSort};
+    int numSorts = sizeof(sorts) / sizeof(sorts[0]);
+
+    int *src = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+    FILE *fp = fopen("counting_sorting_times.dat", "w");
+    fprintf(fp, "# data n counting counting_1t radix pdq merge auto\n");
+    printf("%-8s %10s", "data", "n");
+    for (int a = 0; a < numSorts; a++)
+        printf(" %12s", names[a]);
+    printf("\n");
+
+    for (int d = 0; d < 2; d++)
+    {
+        for (int n = 1000; n <= maxN; n *= 4)
+        {
+            fillDistribution(src, n, d == 0 ? DIST_MOD1000 : DIST_NORMAL);
+            printf("%-8s %10d", dataSets[d], n);
+            fprintf(fp, "%s %d", dataSets[d], n);
+            for (int a = 0; a < numSorts; a++)
+            {
+                if (tooLargeFor(sorts[a], n))
+                {
+                    printf(" %12s", "nan");
+                    fprintf(fp, " nan");
+                    continue;
+                }
+                double t = timeSortCall(sorts[a], src, temp, n);
+                if (!isSorted(temp, n))
+                    printf("Warning: %s output not sorted\n", names[a]);
+                printf(" %12.3g", t);
+                fprintf(fp, " %g", t);
+            }
+            printf("\n");
+            fprintf(fp, "\n");
+            if (n > maxN / 4)
+                break;
+        }
+    }
+
+    fclose(fp);
+    free(src);
+    free(temp);
+    printf("Data saved to counting_sorting_times.dat\n");
+}
+
+// Floating-point sorts on real doubles. SortAlogsv2.c draws normal(50, 10) values and then
+// truncates them to int; here the same values stay doubles and are sorted by qsort, the generic
+// comparison sorts and the total-order sorts, with the int radix sort of the truncated values
+// as the reference. Then the prescan throughput per SIMD level, and a check of every float and
+// double sort against qsort on data full of NaNs (both signs, several payloads), zeros of both
+// signs, infinities and subnormals.
+void doubleQsort(double arr[], int n)
+{
+    qsort(arr, n, sizeof(double), compareDouble);
+}
+
+void doubleTotalRadixSort(double arr[], int n)
+{
+    doubleSortTotal(arr, n, SORT_FAMILY_RADIX);
+}
+
+void doubleTotalMergeSort(double arr[], int n)
+{
+    doubleSortTotal(arr, n, SORT_FAMILY_MERGE);
+}
+
+void doubleTotalIntroSort(double arr[], int n)
+{
+    doubleSortTotal(arr, n, SORT_FAMILY_INTRO);
+}
+
+// Best of three, like timeSortCall
+double timeDoubleSort(void (*sortFunc)(double[], int), const double src[], double temp[], int n)
+{
+    int calls = n < 100000 ? 100000 / (n > 0 ? n : 1) : 1;
+    double best = INFINITY;
+    for (int rep = 0; rep < 3; rep++)
+    {
+        double elapsed = 0.0;
+        for (int c = 0; c < calls; c++)
+        {
+            memcpy(temp, src, n * sizeof(double));
+            double start = wallTime();
+            sortFunc(temp, n);
+            elapsed += wallTime() - start;
+        }
+        if (elapsed / calls < best)
+            best = elapsed / calls;
+    }
+    return best;
+}
+
+// Bit pattern for the special-value check: sign, exponent class and NaN payload all vary
+uint64_t specialDoubleBits(void)
+{
+    uint64_t r = randomU64(), sign = r & 0x8000000000000000ull;
+    switch ((r >> 8) % 8)
+    {
+    case 0: return sign | 0x7FF0000000000000ull | (r >> 12 | 1); // NaN, quiet or signalling
+    case 1: return sign | 0x7FF8000000000000ull;                 // default NaN
+    case 2: return sign;                                         // +-0
+    case 3: return sign | 0x7FF0000000000000ull;                 // +-inf
+    case 4: return sign | (r >> 20);                             // subnormal
+    default: return r;
+    }
+}
+
+uint32_t specialFloatBits(void)
+{
+    uint32_t r = (uint32_t)randomU64(), sign = r & 0x80000000u;
+    switch ((r >> 8) % 8)
+    {
+    case 0: return sign | 0x7F800000u | (r >> 9 | 1);
+    case 1: return sign | 0x7FC00000u;
+    case 2: return sign;
+    case 3: return sign | 0x7F800000u;
+    case 4: return sign | (r >> 12);
+    default: return r;
+    }
+}
+
+void benchmarkFloat(int maxN)
+{
+    const char *names[] = {"qsort", "insertion", "heap", "intro", "merge", "radix", "total_radix",
+                           "total_merge", "total_intro", "int_radix"};
+    void (*sorts[])(double[], int) = {doubleQsort, doubleInsertionSort, doubleHeapSort, doubleIntroSort,
+                                      doubleMergeSort, doubleRadixSort, doubleTotalRadixSort,
+                                      doubleTotalMergeSort, doubleTotalIntroSort, NULL};
+    int numSorts = sizeof(sorts) / sizeof(sorts[0]);
+
+    double *src = (double *)malloc(maxN * sizeof(double));
+    double *temp = (double *)malloc(maxN * sizeof(double));
+    double *expected = (double *)malloc(maxN * sizeof(double));
+    int *intSrc = (int *)malloc(maxN * sizeof(int));
+    int *intTemp = (int *)malloc(maxN * sizeof(int));
+    FILE *fp = fopen("float_sorting_times.dat", "w");
+    fprintf(fp, "# normal(50, 10) doubles: n");
+    printf("normal(50, 10) doubles, seconds\n%10s", "n");
+    for (int a = 0; a < numSorts; a++)
+    {
+        fprintf(fp, " %s", names[a]);
+        printf(" %11s", names[a]);
+    }
+    fprintf(fp, "\n");
+    printf("\n");
+
+    for (int n = 1000; n <= maxN; n *= 4)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            src[i] = generateNormalRandom(50.0, 10.0);
+            intSrc[i] = (int)src[i];
+        }
+        fprintf(fp, "%d", n);
+        printf("%10d", n);
+        for (int a = 0; a < numSorts; a++)
+        {
+            double t;
+            if (sorts[a] == NULL)
+                t = timeSortCall(radixSort, intSrc, intTemp, n);
+            else if (sorts[a] == doubleInsertionSort && n > 65536)
+                t = NAN;
+            else
+            {
+                t = timeDoubleSort(sorts[a], src, temp, n);
+                if (a == 0)
+                    memcpy(expected, temp, n * sizeof(double));
+                else
+                    for (int i = 0; i < n; i++)
+                        if (compareDouble(&temp[i], &expected[i]) != 0)
+                        {
+                            printf("\nWarning: %s disagrees with qsort\n", names[a]);
+                            break;
+                        }
+            }
+            fprintf(fp, " %g", t);
+            printf(" %11.4g", t);
+        }
+        fprintf(fp, "\n");
+        printf("\n");
+        if (n > maxN / 4)
+            break;
+    }
+
+    // Prescan throughput over the largest array, which stays in src
+    int n = maxN;
+    for (int i = 0; i < n; i++)
+        src[i] = generateNormalRandom(50.0, 10.0);
+    int detected = simdLevel();
+    fprintf(fp, "\n\n# prescan of %d doubles: level gb_per_s\n", n);
+    printf("Prescan of %d doubles:\n", n);
+    for (int level = SIMD_SCALAR; level <= detected; level++)
+    {
+        simdLevelOverride = level;
+        double min, max, best = INFINITY;
+        for (int rep = 0; rep < 5; rep++)
+        {
+            double start = wallTime();
+            doublePrescan(src, n, &min, &max);
+            double elapsed = wallTime() - start;
+            if (elapsed < best)
+                best = elapsed;
+        }
+        double gbps = n * sizeof(double) / best / 1e9;
+        fprintf(fp, "%s %f\n", simdLevelNames[level], gbps);
+        printf("  %-8s %8.2f GB/s (min %.3f, max %.3f)\n", simdLevelNames[level], gbps, min, max);
+    }
+    simdLevelOverride = -1;
+
+    // Special values: every sort must agree with qsort on the total-order keys
+    int failures = 0;
+    n = maxN < 100000 ? maxN : 100000;
+    float *floats = (float *)malloc(n * sizeof(float));
+    float *floatSrc = (float *)malloc(n * sizeof(float));
+    float *floatExpected = (float *)malloc(n * sizeof(float));
+    for (int i = 0; i < n; i++)
+    {
+        uint64_t d = specialDoubleBits();
+        uint32_t f = specialFloatBits();
+        memcpy(&src[i], &d, sizeof(d));
+        memcpy(&floatSrc[i], &f, sizeof(f));
+    }
+    memcpy(expected, src, n * sizeof(double));
+    qsort(expected, n, sizeof(double), compareDouble);
+    memcpy(floatExpected, floatSrc, n * sizeof(float));
+    qsort(floatExpected, n, sizeof(float), compareFloat);
+    for (int a = 5; a < numSorts - 1; a++)
+    {
+        memcpy(temp, src, n * sizeof(double));
+        sorts[a](temp, n);
+        for (int i = 0; i < n; i++)
+            if (doubleKey(temp[i]) != doubleKey(expected[i]))
+            {
+                printf("FAIL double %s at %d\n", names[a], i);
+                failures++;
+                break;
+            }
+    }
+    // radix, then the total-order sorts by family
+    int families[] = {-1, SORT_FAMILY_RADIX, SORT_FAMILY_MERGE, SORT_FAMILY_INTRO};
+    for (int a = 0; a < 4; a++)
+    {
+        memcpy(floats, floatSrc, n * sizeof(float));
+        if (families[a] < 0)
+            floatRadixSort(floats, n);
+        else
+            floatSortTotal(floats, n, families[a]);
+        for (int i = 0; i < n; i++)
+            if (floatKey(floats[i]) != floatKey(floatExpected[i]))
+            {
+                printf("FAIL float %s at %d\n", names[5 + a], i);
+                failures++;
+                break;
+            }
+    }
+    printf("Special values (n = %d, NaN, +-0, +-inf, subnormals): %s\n", n,
+           failures == 0 ? "every sort agrees with qsort" : "FAILED");
+
+    fclose(fp);
+    free(floats);
+    free(floatSrc);
+    free(floatExpected);
+    free(intSrc);
+    free(intTemp);
+    free(expected);
+    free(temp);
+    free(src);
+    printf("Data saved to float_sorting_times.dat\n");
+}
+
+// Time, hardware counters and (with -DSORT_COUNT_OPS) comparisons and swaps for every table
+// algorithm on random input. Unavailable counters and uninstrumented algorithms write nan.
+void benchmarkCounters(int maxN)
+{
+    PerfCounters pc;
+    perfOpen(&pc);
+    printf("Counters:");
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+        printf(" %s%s", perfEventNames[e], perfAvailable(&pc, e) ? "" : " (unavailable)");
+#ifdef SORT_COUNT_OPS
+    printf(", comparisons, swaps\n");
+#else
+    printf("; comparisons and swaps need -DSORT_COUNT_OPS\n");
+#endif
+
+    int *src = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+    FILE *fp = fopen("counter_sorting_times.dat", "w");
+    fprintf(fp, "# n seconds");
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+        fprintf(fp, " %s", perfEventNames[e]);
+    fprintf(fp, " comparisons swaps name\n");
+    printf("%10s %-20s %10s %12s %12s %12s %12s %12s %12s %14s %14s\n", "n", "algorithm", "seconds", "cycles",
+           "instructions", "branch_miss", "l1d_miss", "llc_miss", "dtlb_miss", "comparisons", "swaps");
+
+    for (long long n = 1000; n <= maxN; n *= 10)
+    {
+        fillDistribution(src, (int)n, DIST_RANDOM);
+        for (int a = 0; a < numSortAlgorithms; a++)
+        {
+            void (*sort)(int[], int) = sortAlgorithms[a].sort;
+            if (tooLargeFor(sort, n))
+                continue;
+
+            copyArray(src, temp, (int)n);
+            double comparisons = NAN, swaps = NAN;
+#ifdef SORT_COUNT_OPS
+            sortComparisons = sortSwaps = 0;
+#endif
+            double start = wallTime();
+            perfStart(&pc);
+            sort(temp, (int)n);
+            perfStop(&pc);
+            double seconds = wallTime() - start;
+#ifdef SORT_COUNT_OPS
+            // Hybrids reach the hooks only through their insertion or heap sort fallbacks
+            if (isQuadraticSort(sort) || sort == mergeSortRange || sort == quickSortRange || sort == heapSort ||
+                sort == shellSort)
+            {
+                comparisons = (double)sortComparisons;
+                swaps = (double)sortSwaps;
+            }
+#endif
+            if (!isSorted(temp, (int)n))
+                printf("Warning: %s output not sorted\n", sortAlgorithms[a].name);
+
+            printf("%10lld %-20s %10.4g", n, sortAlgorithms[a].name, seconds);
+            fprintf(fp, "%lld %g", n, seconds);
+            for (int e = 0; e < PERF_EVENT_COUNT; e++)
+            {
+                printf(" %12.4g", perfValue(&pc, e));
+                fprintf(fp, " %g", perfValue(&pc, e));
+            }
+            printf(" %14.6g %14.6g\n", comparisons, swaps);
+            fprintf(fp, " %g %g \"%s\"\n", comparisons, swaps, sortAlgorithms[a].name);
+        }
+    }
+
+    perfClose(&pc);
+    fclose(fp);
+    free(src);
+    free(temp);
+    printf("Data saved to counter_sorting_times.dat\n");
+}
+
+// Multiway merge sort against the binary merge sorts: time and the cache and TLB counters that
+// track memory traffic (llc_misses * 64 bytes approximates the DRAM traffic). passes counts the
+// sweeps over the whole array: the run pass plus the merge passes, or log2(n) levels for
+// mergeSort. mergeSort itself keeps its halves in VLAs on the stack, so it stops at 10^6.
+void benchmarkMultiway(int maxN)
+{
+    const char *names[] = {"mergeSort", "stable", "multiway_k2", "multiway"};
+    int numSorts = sizeof(names) / sizeof(names[0]);
+    const int counters[] = {PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_DTLB_MISSES};
+    PerfCounters pc;
+    perfOpen(&pc);
+    for (int c = 0; c < 3; c++)
+        if (!perfAvailable(&pc, counters[c]))
+            printf("Counter %s unavailable, written as nan\n", perfEventNames[counters[c]]);
+
+    int *src = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+    FILE *fp = fopen("multiway_sorting_times.dat", "w");
+    fprintf(fp, "# n algorithm seconds passes l1d_misses llc_misses dtlb_misses llc_mb\n");
+    printf("%10s %-12s %10s %7s %12s %12s %12s %10s\n", "n", "algorithm", "seconds", "passes", "l1d_miss",
+           "llc_miss", "dtlb_miss", "llc MB");
+
+    for (long long n = 100000; n <= maxN; n *= 10)
+    {
+        fillDistribution(src, (int)n, DIST_RANDOM);
+        for (int a = 0; a < numSorts; a++)
+        {
+            if (a == 0 && tooLargeFor(mergeSortRange, n))
+                continue;
+            copyArray(src, temp, (int)n);
+            int passes = 0;
+            double start = wallTime();
+            perfStart(&pc);
+            if (a == 0)
+                mergeSortRange(temp, (int)n);
+            else if (a == 1)
+                intStableSort(temp, (int)n);
+            else
+                passes = multiwayMergeSortFanIn(temp, (int)n, a == 2 ? 2 : MULTIWAY_FAN_IN);
+            perfStop(&pc);
+            double seconds = wallTime() - start;
+            if (!isSorted(temp, (int)n))
+                printf("Warning: %s output not sorted\n", names[a]);
+            // Binary merge sorts sweep the array once per level
+            if (a < 2)
+                passes = (int)ceil(log2((double)n));
+            else
+                passes++;
+
+            double llcMB = perfValue(&pc, PERF_LLC_MISSES) * 64 / (1 << 20);
+            printf("%10lld %-12s %10.4f %7d %12.4g %12.4g %12.4g %10.1f\n", n, names[a], seconds, passes,
+                   perfValue(&pc, PERF_L1D_MISSES), perfValue(&pc, PERF_LLC_MISSES), perfValue(&pc, PERF_DTLB_MISSES),
+                   llcMB);
+            fprintf(fp, "%lld %s %g %d %g %g %g %g\n", n, names[a], seconds, passes, perfValue(&pc, PERF_L1D_MISSES),
+                    perfValue(&pc, PERF_LLC_MISSES), perfValue(&pc, PERF_DTLB_MISSES), llcMB);
+        }
+    }
+
+    perfClose(&pc);
+    fclose(fp);
+    free(src);
+    free(temp);
+    printf("Data saved to multiway_sorting_times.dat\n");
+}
+
+// Incremental updates: the sorted container against keeping one sorted array. From n sorted
+// ints, rounds of batch random inserts are each followed by SORTED_BENCH_QUERIES range counts.
+// The array is re-sorted after every batch with pdqSort or intStableSort (which merges the
+// presorted runs), or gets the sorted batch merged in. Then rounds of batch deletes: the
+// container's tombstones against a merge-difference pass over the array. Every method must
+// give the same query answers.
+#define SORTED_BENCH_QUERIES 1000
+#define SORTED_BENCH_ROUNDS 100
+
+// Range counts over a sorted array; returns their sum as a checksum
+long long countRangesInArray(const int arr[], int n, const int lo[], const int hi[], int queries)
+{
+    long long sum = 0;
+    for (int q = 0; q < queries; q++)
+        sum += intUpperBound(arr, n, hi[q]) - intLowerBound(arr, n, lo[q]);
+    return sum;
+}
+
+void benchmarkIncremental(int n, int batch)
+{
+    const char *names[] = {"pdq_resort", "stable_resort", "sort_merge", "container"};
+    int numMethods = sizeof(names) / sizeof(names[0]);
+    int rounds = SORTED_BENCH_ROUNDS, queries = SORTED_BENCH_QUERIES;
+    int capacity = n + rounds * batch;
+    int *initial = (int *)malloc(n * sizeof(int));
+    int *inserts = (int *)malloc((size_t)rounds * batch * sizeof(int));
+    int *lo = (int *)malloc((size_t)rounds * queries * sizeof(int));
+    int *hi = (int *)malloc((size_t)rounds * queries * sizeof(int));
+    fillDistribution(initial, n, DIST_RANDOM);
+    pdqSort(initial, n);
+    fillDistribution(inserts, rounds * batch, DIST_RANDOM);
+    for (int q = 0; q < rounds * queries; q++)
+    {
+        int a = (int)(uint32_t)randomU64(), width = (int)(randomU64() % (1u << 24));
+        lo[q] = a;
+        hi[q] = a > INT_MAX - width ? INT_MAX : a + width;
+    }
+
+    FILE *fp = fopen("incremental_sorting_times.dat", "w");
+    fprintf(fp, "# n = %d, batch = %d, %d rounds, %d queries per round\n", n, batch, rounds, queries);
+    fprintf(fp, "# method insert_melem_s query_kq_s delete_melem_s\n");
+    printf("n = %d, %d rounds of %d inserts, %d range counts after each\n", n, rounds, batch, queries);
+    printf("%-14s %14s %14s %14s\n", "method", "insert Mel/s", "query Kq/s", "delete Mel/s");
+
+    int *arr = (int *)malloc(capacity * sizeof(int));
+    int *other = (int *)malloc(((size_t)capacity + batch) * sizeof(int)); // sorted batch, then the merge
+    long long expected = -1;
+    for (int m = 0; m < numMethods; m++)
+    {
+        SortedContainer sc;
+        int size = n;
+        double insertSeconds = 0.0, querySeconds = 0.0, deleteSeconds = NAN;
+        long long checksum = 0;
+        memcpy(arr, initial, n * sizeof(int));
+        if (m == 3)
+        {
+            sortedInit(&sc);
+            sortedInsert(&sc, initial, n);
+        }
+
+        for (int r = 0; r < rounds; r++)
+        {
+            int *delta = inserts + (size_t)r * batch;
+            double start = wallTime();
+            if (m == 0 || m == 1)
+            {
+                memcpy(arr + size, delta, batch * sizeof(int));
+                size += batch;
+                if (m == 0)
+                    pdqSort(arr, size);
+                else
+                    intStableSort(arr, size);
+            }
+            else if (m == 2)
+            {
+                memcpy(other, delta, batch * sizeof(int));
+                autoSort(other, batch);
+                mergeSortedInts(arr, size, other, batch, other + batch);
+                memcpy(arr, other + batch, (size + batch) * sizeof(int));
+                size += batch;
+            }
+            else
+            {
+                sortedInsert(&sc, delta, batch);
+                size += batch;
+            }
+            insertSeconds += wallTime() - start;
+
+            start = wallTime();
+            if (m == 3)
+                for (int q = 0; q < queries; q++)
+                    checksum += sortedCountRange(&sc, lo[r * queries + q], hi[r * queries + q]);
+            else
+                checksum += countRangesInArray(arr, size, lo + r * queries, hi + r * queries, queries);
+            querySeconds += wallTime() - start;
+        }
+        if (expected < 0)
+            expected = checksum;
+        else if (checksum != expected)
+            printf("Warning: %s answered the queries differently\n", names[m]);
+
+        // Deletes of present elements: every stride-th one of the sorted array, shifted per round
+        if (m >= 2)
+        {
+            int *reference = (int *)malloc(capacity * sizeof(int));
+            int *doomed = (int *)malloc(batch * sizeof(int));
+            int refSize = size;
+            memcpy(reference, arr, size * sizeof(int));
+            if (m == 3)
+            {
+                // The container's contents, read back through a full range query
+                refSize = sortedRange(&sc, INT_MIN, INT_MAX, reference, capacity);
+                if (refSize != size)
+                    printf("Warning: container holds %d elements, expected %d\n", refSize, size);
+            }
+            deleteSeconds = 0.0;
+            for (int r = 0; r < rounds && refSize > batch; r++)
+            {
+                int stride = refSize / batch;
+                for (int i = 0; i < batch; i++)
+                    doomed[i] = reference[i * stride + r % stride];
+                // Only the container's deletes and the array's difference pass are timed
+                double start = wallTime();
+                if (m == 3)
+                {
+                    sortedDelete(&sc, doomed, batch);
+                    deleteSeconds += wallTime() - start;
+                }
+                int kept = 0, d = 0;
+                for (int i = 0; i < refSize; i++)
+                {
+                    if (d < batch && doomed[d] == reference[i])
+                        d++;
+                    else
+                        reference[kept++] = reference[i];
+                }
+                if (m == 2)
+                    deleteSeconds += wallTime() - start;
+                refSize = kept;
+                if (m == 3 && sortedCountRange(&sc, INT_MIN, INT_MAX) != refSize)
+                    printf("Warning: container size differs after deletes\n");
+            }
+            free(doomed);
+            free(reference);
+        }
+
+        printf("%-14s %14.3f %14.1f %14.3f\n", names[m], (double)rounds * batch / insertSeconds / 1e6,
+               rounds * queries / querySeconds / 1e3, (double)rounds * batch / deleteSeconds / 1e6);
+        fprintf(fp, "%s %f %f %f\n", names[m], (double)rounds * batch / insertSeconds / 1e6,
+                rounds * queries / querySeconds / 1e3, (double)rounds * batch / deleteSeconds / 1e6);
+        if (m == 3)
+            sortedFree(&sc);
+    }
+
+    fclose(fp);
+    free(other);
+    free(arr);
+    free(hi);
+    free(lo);
+    free(inserts);
+    free(initial);
+    printf("Data saved to incremental_sorting_times.dat\n");
+}
+
+// Throughput and extra peak RSS (above the input copy) of the merge sorts and heap sort
+void benchmarkInPlace(int maxN)
+{
+    const char *names[] = {"merge", "stable", "inplace", "heap"};
+    void (*sorts[])(int[], int) = {mergeSortRange, intStableSort, inPlaceMergeSortRange, heapSort};
+    int numSorts = sizeof(sorts) / sizeof(sorts[0]);
+
+    int *src = (int *)malloc(maxN * sizeof(int));
+    FILE *fp = fopen("inplace_sorting_times.dat", "w");
+    fprintf(fp, "# n merge_s merge_kb stable_s stable_kb inplace_s inplace_kb heap_s heap_kb\n");
+    printf("%10s", "n");
+    for (int a = 0; a < numSorts; a++)
+        printf(" %9s Melem/s %8s KB", names[a], names[a]);
+    printf("\n");
+
+    for (long long n = 10000; n <= maxN; n *= 10)
+    {
+        fillDistribution(src, (int)n, DIST_RANDOM);
+        double seconds;
+        long baseKB = 0, peakKB;
+        measureSortInChild(NULL, src, (int)n, &seconds, &baseKB);
+        printf("%10lld", n);
+        fprintf(fp, "%lld", n);
+        for (int a = 0; a < numSorts; a++)
+        {
+            if (tooLargeFor(sorts[a], n) ||
+                measureSortInChild(sorts[a], src, (int)n, &seconds, &peakKB) != 0)
+            {
+                printf(" %17s %11s", "nan", "nan");
+                fprintf(fp, " nan nan");
+                continue;
+            }
+            long extraKB = peakKB > baseKB ? peakKB - baseKB : 0;
+            printf(" %17.2f %11ld", n / seconds / 1e6, extraKB);
+            fprintf(fp, " %g %ld", seconds, extraKB);
+        }
+        printf("\n");
+        fprintf(fp, "\n");
+    }
+
+    fclose(fp);
+    free(src);
+    printf("Data saved to inplace_sorting_times.dat\n");
+}
+
+// Declared vs observed stability of the record sorts, then time and extra peak memory of
+// every int sort, stable ones first
+void benchmarkStability(int n)
+{
+    printf("Stability on %d tagged records with 100 distinct keys:\n", n);
+    for (int a = 0; a < numTaggedSortAlgorithms; a++)
+    {
+        // The quadratic insertion sort gets a smaller input
+        int size = taggedSortAlgorithms[a].sort == taggedInsertionSort && n > 20000 ? 20000 : n;
+        int observed = verifyStability(taggedSortAlgorithms[a].sort, size, 100);
+        const char *verdict = observed < 0 ? "NOT SORTED" : observed == taggedSortAlgorithms[a].stable ? "ok" : "MISMATCH";
+        printf("  %-20s declared %-8s observed %-8s %s\n", taggedSortAlgorithms[a].name,
+               taggedSortAlgorithms[a].stable ? "stable" : "unstable", observed == 1 ? "stable" : "unstable", verdict);
+    }
+
+    int *src = (int *)malloc(n * sizeof(int));
+    fillDistribution(src, n, DIST_RANDOM);
+    double seconds;
+    long baseKB = 0, peakKB;
+    if (measureSortInChild(NULL, src, n, &seconds, &baseKB) != 0)
+        printf("Warning: could not fork to measure memory\n");
+
+    FILE *fp = fopen("stability_times.dat", "w");
+    fprintf(fp, "# n = %d\n# stable seconds extra_kb name\n", n);
+    printf("\nInt sorts on %d random keys (extra memory = peak RSS above the input copy):\n", n);
+    printf("  %-20s %-8s %12s %12s\n", "algorithm", "stable", "seconds", "extra KB");
+    for (int stable = 1; stable >= 0; stable--)
+    {
+        for (int a = 0; a < numSortAlgorithms; a++)
+        {
+            void (*sort)(int[], int) = sortAlgorithms[a].sort;
+            if (sortAlgorithms[a].stable != stable)
+                continue;
+            if (tooLargeFor(sort, n))
+                continue;
+            if (measureSortInChild(sort, src, n, &seconds, &peakKB) != 0)
+            {
+                printf("  %-20s failed\n", sortAlgorithms[a].name);
+                continue;
+            }
+            long extraKB = peakKB > baseKB ? peakKB - baseKB : 0;
+            printf("  %-20s %-8s %12.4g %12ld\n", sortAlgorithms[a].name, stable ? "yes" : "no", seconds, extraKB);
+            fprintf(fp, "%d %g %ld \"%s\"\n", stable, seconds, extraKB, sortAlgorithms[a].name);
+        }
+    }
+
+    fclose(fp);
+    free(src);
+    printf("Data saved to stability_times.dat\n");
+}
+
+// Key-only sort vs argsort vs carrying 8-64 byte payloads (SoA) or records (AoS), per family.
+// Every payload and record starts with a copy of its key, which is checked after the sort.
+void benchmarkPayload(int n)
+{
+    void (*keyOnly[])(int[], int) = {radixSort, mergeSortRange, introSort};
+    size_t sizes[] = {8, 16, 32, 64};
+    int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+    int *src = (int *)malloc(n * sizeof(int));
+    int *keys = (int *)malloc(n * sizeof(int));
+    int *idx = (int *)malloc(n * sizeof(int));
+    char *payload = (char *)malloc((size_t)n * 64);
+    fillDistribution(src, n, DIST_RANDOM);
+
+    FILE *fp = fopen("payload_sorting_times.dat", "w");
+    fprintf(fp, "# n = %d\n# family key_only argsort soa8 soa16 soa32 soa64 aos8 aos16 aos32 aos64\n", n);
+    printf("n = %d\n%-6s %10s %10s", n, "family", "key_only", "argsort");
+    for (int l = 0; l < 2; l++)
+        for (int z = 0; z < numSizes; z++)
+            printf(" %7s%-3d", l == 0 ? "soa" : "aos", (int)sizes[z]);
+    printf("\n");
+
+    for (int f = 0; f < SORT_FAMILY_COUNT; f++)
+    {
+        printf("%-6s", sortFamilyNames[f]);
+        fprintf(fp, "%s", sortFamilyNames[f]);
+
+        double t = NAN;
+        if (!tooLargeFor(keyOnly[f], n))
+            t = timeIntSort(keyOnly[f], src, keys, n);
+        printf(" %10.3g", t);
+        fprintf(fp, " %g", t);
+
+        double start = wallTime();
+        argsort(src, n, idx, NULL, f);
+        t = wallTime() - start;
+        for (int i = 1; i < n; i++)
+            if (src[idx[i - 1]] > src[idx[i]])
+            {
+                printf("Warning: %s argsort out of order\n", sortFamilyNames[f]);
+                break;
+            }
+        printf(" %10.3g", t);
+        fprintf(fp, " %g", t);
+
+        for (int l = 0; l < 2; l++)
+        {
+            for (int z = 0; z < numSizes; z++)
+            {
+                size_t size = sizes[z];
+                copyArray(src, keys, n);
+                for (int i = 0; i < n; i++)
+                {
+                    memset(payload + (size_t)i * size, 0, size);
+                    memcpy(payload + (size_t)i * size, &src[i], sizeof(int));
+                    if (l == 1)
+                        memcpy(payload + (size_t)i * size + sizeof(int), &src[i], sizeof(int));
+                }
+
+                start = wallTime();
+                if (l == 0)
+                    sortKeysWithPayload(keys, payload, n, size, f);
+                else
+                    sortRecordsByKey(payload, n, size, 0, f);
+                t = wallTime() - start;
+
+                int ok = 1, previous = INT_MIN;
+                for (int i = 0; i < n && ok; i++)
+                {
+                    char *item = payload + (size_t)i * size;
+                    int key = keys[i], copy;
+                    if (l == 1)
+                        memcpy(&key, item, sizeof(int));
+                    memcpy(&copy, item + (l == 0 ? 0 : sizeof(int)), sizeof(int));
+                    ok = key == copy && previous <= key;
+                    previous = key;
+                }
+                if (!ok)
+                    printf("Warning: %s %s%d payload out of order\n", sortFamilyNames[f], l == 0 ? "soa" : "aos",
+                           (int)size);
+                printf(" %10.3g", t);
+                fprintf(fp, " %g", t);
+            }
+        }
+        printf("\n");
+        fprintf(fp, "\n");
+    }
+
+    fclose(fp);
+    free(src);
+    free(keys);
+    free(idx);
+    free(payload);
+    printf("Data saved to payload_sorting_times.dat\n");
+}
+
+// Selection primitives vs a full pdqSort and slice, for several k on one random array
+void benchmarkSelect(int n, int threads)
+{
+    const char *names[] = {"full_sort", "introselect", "partial", "topk_stream", "par_select", "par_partial",
+                           "par_topk"};
+    int numMethods = sizeof(names) / sizeof(names[0]);
+    long long ks[] = {10, 1000, n / 100, n / 2};
+    int numK = sizeof(ks) / sizeof(ks[0]);
+
+    int *src = (int *)malloc(n * sizeof(int));
+    int *temp = (int *)malloc(n * sizeof(int));
+    int *out = (int *)malloc(n * sizeof(int));
+    int *sorted = (int *)malloc(n * sizeof(int));
+    fillDistribution(src, n, DIST_RANDOM);
+    copyArray(src, sorted, n);
+    pdqSort(sorted, n);
+
+    FILE *fp = fopen("select_times.dat", "w");
+    fprintf(fp, "# n = %d, threads = %d\n# k", n, threads);
+    printf("n = %d, threads = %d\n%10s", n, threads, "k");
+    for (int m = 0; m < numMethods; m++)
+    {
+        fprintf(fp, " %s", names[m]);
+        printf(" %12s", names[m]);
+    }
+    fprintf(fp, "\n");
+    printf("\n");
+
+    for (int q = 0; q < numK; q++)
+    {
+        int k = (int)ks[q];
+        if (k < 1 || k > n)
+            continue;
+        fprintf(fp, "%d", k);
+        printf("%10d", k);
+        for (int m = 0; m < numMethods; m++)
+        {
+            // Every method reports the k smallest (or the k-th) from a fresh copy
+            copyArray(src, temp, n);
+            double start = wallTime();
+            int ok = 1;
+            switch (m)
+            {
+            case 0:
+                pdqSort(temp, n);
+                memcpy(out, temp, k * sizeof(int));
+                ok = memcmp(out, sorted, k * sizeof(int)) == 0;
+                break;
+            case 1:
+                introSelect(temp, n, k - 1);
+                ok = temp[k - 1] == sorted[k - 1];
+                break;
+            case 2:
+                partialSort(temp, n, k);
+                ok = memcmp(temp, sorted, k * sizeof(int)) == 0;
+                break;
+            case 3:
+            {
+                TopK tk;
+                topKInit(&tk, k);
+                for (int i = 0; i < n; i += 65536)
+                    topKPush(&tk, temp + i, n - i < 65536 ? n - i : 65536);
+                topKResult(&tk, out);
+                topKFree(&tk);
+                ok = memcmp(out, sorted, k * sizeof(int)) == 0;
+                break;
+            }
+            case 4:
+                ok = parallelSelect(temp, n, k - 1, threads) == sorted[k - 1];
+                break;
+            case 5:
+                parallelPartialSort(temp, n, k, threads);
+                ok = memcmp(temp, sorted, k * sizeof(int)) == 0;
+                break;
+            default:
+                parallelTopK(temp, n, k, out, threads);
+                ok = memcmp(out, sorted, k * sizeof(int)) == 0;
+                break;
+            }
+            double t = wallTime() - start;
+            if (!ok)
+                printf("Warning: %s result wrong for k = %d\n", names[m], k);
+            fprintf(fp, " %g", t);
+            printf(" %12.3g", t);
+        }
+        fprintf(fp, "\n");
+        printf("\n");
+    }
+
+    fclose(fp);
+    free(src);
+    free(temp);
+    free(out);
+    free(sorted);
+    printf("Data saved to select_times.dat\n");
+}
+
+void heapSortBinary(int arr[], int n) { heapSortDary(arr, n, 2); }
+void heapSort8ary(int arr[], int n) { heapSortDary(arr, n, 8); }
+
+void benchmarkHeap(int maxN)
+{
+    const char *names[] = {"heap", "floyd2", "floyd4", "floyd8"};
+    void (*sorts[])(int[], int) = {heapSort, heapSortBinary, heapSortBottomUp, heapSort8ary};
+    int numSorts = sizeof(sorts) / sizeof(sorts[0]);
+
+    int *src = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+    FILE *fp = fopen("heap_sorting_times.dat", "w");
+    fprintf(fp, "# n heap floyd2 floyd4 floyd8 partial_1pct\n");
+    printf("%10s", "n");
+    for (int a = 0; a < numSorts; a++)
+        printf(" %12s", names[a]);
+    printf(" %12s\n", "partial_1pct");
+
+    for (long long n = 10000; n <= maxN; n *= 10)
+    {
+        fillDistribution(src, (int)n, DIST_RANDOM);
+        printf("%10lld", n);
+        fprintf(fp, "%lld", n);
+        for (int a = 0; a < numSorts; a++)
+        {
+            double t = timeSortCall(sorts[a], src, temp, (int)n);
+            if (!isSorted(temp, (int)n))
+                printf("Warning: %s output not sorted\n", names[a]);
+            printf(" %12.3g", t);
+            fprintf(fp, " %g", t);
+        }
+
+        // Smallest 1% in order, from the same heap engine
+        int k = (int)(n / 100);
+        copyArray(src, temp, (int)n);
+        double start = wallTime();
+        heapPartialSort(temp, (int)n, k);
+        double t = wallTime() - start;
+        if (!isSorted(temp, k))
+            printf("Warning: partial sort prefix not sorted\n");
+        printf(" %12.3g\n", t);
+        fprintf(fp, " %g\n", t);
+    }
+
+    fclose(fp);
+    free(src);
+    free(temp);
+    printf("Data saved to heap_sorting_times.dat\n");
+}
+
+// Sweeps every gap sequence over every distribution. Each distribution is its own gnuplot data
+// block (two blank lines apart, select with "index d"), columns: n then one time per sequence.
+void benchmarkShell(int maxN)
+{
+    int *src = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+    double logRatio[GAP_SEQUENCES] = {0};
+    int cells = 0;
+
+    FILE *fp = fopen("shell_sorting_times.dat", "w");
+    fprintf(fp, "# n");
+    printf("%-14s %10s", "data", "n");
+    for (int g = 0; g < GAP_SEQUENCES; g++)
+    {
+        fprintf(fp, " %s", gapSequenceNames[g]);
+        printf(" %12s", gapSequenceNames[g]);
+    }
+    fprintf(fp, "\n");
+    printf("\n");
+
+    for (int d = 0; d < DIST_COUNT; d++)
+    {
+        fprintf(fp, "%s# %s\n", d > 0 ? "\n\n" : "", distributionNames[d]);
+        for (long long n = 1000; n <= maxN; n *= 10)
+        {
+            double t[GAP_SEQUENCES], best = INFINITY;
+            fillDistribution(src, (int)n, d);
+            printf("%-14s %10lld", distributionNames[d], n);
+            fprintf(fp, "%lld", n);
+            for (int g = 0; g < GAP_SEQUENCES; g++)
+            {
+                int calls = n < 100000 ? 100000 / (int)n : 1;
+                double start = wallTime();
+                for (int c = 0; c < calls; c++)
+                {
+                    copyArray(src, temp, (int)n);
+                    shellSortGaps(temp, (int)n, g);
+                }
+                t[g] = (wallTime() - start) / calls;
+                if (!isSorted(temp, (int)n))
+                    printf("Warning: %s gaps output not sorted\n", gapSequenceNames[g]);
+                if (t[g] < best)
+                    best = t[g];
+                printf(" %12.3g", t[g]);
+                fprintf(fp, " %g", t[g]);
+            }
+            for (int g = 0; g < GAP_SEQUENCES; g++)
+                logRatio[g] += log(t[g] / best);
+            cells++;
+            printf("\n");
+            fprintf(fp, "\n");
+        }
+    }
+    fclose(fp);
+
+    // Geometric mean slowdown against the fastest sequence of each row
+    int bestSequence = 0;
+    printf("\nGeometric mean slowdown vs fastest per row:\n");
+    for (int g = 0; g < GAP_SEQUENCES; g++)
+    {
+        printf("  %-12s %.3f%s\n", gapSequenceNames[g], exp(logRatio[g] / cells),
+               g == SHELL_DEFAULT_GAPS ? " (current default)" : "");
+        if (logRatio[g] < logRatio[bestSequence])
+            bestSequence = g;
+    }
+    printf("Best default on this host: %s\n", gapSequenceNames[bestSequence]);
+
+    free(src);
+    free(temp);
+    printf("Data saved to shell_sorting_times.dat\n");
+}
+
+// Samplesort scaling: parallel samplesort, merge sort and radix sort at 1..N threads against the
+// single-threaded sorts, per distribution. Each distribution is a gnuplot data block ("index d"),
+// columns: threads, the three parallel times, then the serial ones (repeated on every row).
+int benchThreads = 1;
+
+void sampleSortBench(int arr[], int n) { parallelSampleSort(arr, n, benchThreads); }
+void mergeSortBench(int arr[], int n) { parallelMergeSort(arr, n, benchThreads); }
+void radixSortBench(int arr[], int n) { parallelRadixSort(arr, n, benchThreads); }
+
+void benchmarkSampleSort(int n, int maxThreads)
+{
+    SortAlgorithm parallel[] = {
+        {"samplesort", sampleSortBench, 0},
+        {"parallel_merge", mergeSortBench, 1},
+        {"parallel_radix", radixSortBench, 1},
+    };
+    SortAlgorithm serial[] = {
+        {"pdq", pdqSort, 0},
+        {"intro", introSort, 0},
+        {"radix", radixSort, 1},
+        {"stable_merge", intStableSort, 1},
+    };
+    int numParallel = sizeof(parallel) / sizeof(parallel[0]);
+    int numSerial = sizeof(serial) / sizeof(serial[0]);
+    int *src = (int *)malloc(n * sizeof(int));
+    int *temp = (int *)malloc(n * sizeof(int));
+
+    FILE *fp = fopen("samplesort_times.dat", "w");
+    fprintf(fp, "# threads");
+    printf("n = %d, threads up to %d\n%-14s %8s", n, maxThreads, "data", "threads");
+    for (int a = 0; a < numParallel; a++)
+    {
+        fprintf(fp, " %s", parallel[a].name);
+        printf(" %15s", parallel[a].name);
+    }
+    for (int a = 0; a < numSerial; a++)
+    {
+        fprintf(fp, " %s", serial[a].name);
+        printf(" %13s", serial[a].name);
+    }
+    fprintf(fp, "\n");
+    printf("\n");
+
+    for (int d = 0; d < DIST_COUNT; d++)
+    {
+        double serialTime[8];
+        fillDistribution(src, n, d);
+        for (int a = 0; a < numSerial; a++)
+            serialTime[a] = timeSortCall(serial[a].sort, src, temp, n);
+
+        fprintf(fp, "%s# %s\n", d > 0 ? "\n\n" : "", distributionNames[d]);
+        for (int threads = 1;; threads *= 2)
+        {
+            if (threads > maxThreads)
+                threads = maxThreads;
+            benchThreads = threads;
+            printf("%-14s %8d", distributionNames[d], threads);
+            fprintf(fp, "%d", threads);
+            for (int a = 0; a < numParallel; a++)
+            {
+                double t = timeSortCall(parallel[a].sort, src, temp, n);
+                if (!isSorted(temp, n))
+                    printf("\nWarning: %s output not sorted\n", parallel[a].name);
+                printf(" %15.5f", t);
+                fprintf(fp, " %f", t);
+            }
+            for (int a = 0; a < numSerial; a++)
+            {
+                printf(" %13.5f", serialTime[a]);
+                fprintf(fp, " %f", serialTime[a]);
+            }
+            printf("\n");
+            fprintf(fp, "\n");
+            if (threads == maxThreads)
+                break;
+        }
+    }
+
+    fclose(fp);
+    free(src);
+    free(temp);
+    printf("Data saved to samplesort_times.dat\n");
+}
+
+// String sorts against qsort with strcmp on newline-delimited data: synthetic file paths and
+// IDs of n lines each, plus the file given on the command line. Every data set goes through
+// a file and loadStringFile(). Results are checked line by line against the qsort output.
+typedef struct
+{
+    const char *name;
+    void (*sort)(const char *, StringRef[], int);
+} StringSortAlgorithm;
+
+StringSortAlgorithm stringSortAlgorithms[] = {
+    {"multikey", multikeyQuicksort},
+    {"msd_lcp_merge", stringRadixSort},
+    {"burstsort", burstSort},
+};
+int numStringSortAlgorithms = sizeof(stringSortAlgorithms) / sizeof(stringSortAlgorithms[0]);
+
+int compareCStrings(const void *a, const void *b) { return strcmp(*(const char *const *)a, *(const char *const *)b); }
+
+// kind 0: file paths with shared directory prefixes, kind 1: fixed-format hexadecimal IDs
+int writeStringBenchFile(const char *path, int n, int kind)
+{
+    static const char *dirs[] = {"usr", "lib", "share", "src", "include", "home", "build", "docs", "var", "log",
+                                 "cache", "tmp", "project", "test", "assets", "config"};
+    static const char *exts[] = {"c", "h", "txt", "json", "png", "so"};
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        printf("Error opening %s.\n", path);
+        return -1;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        if (kind == 0)
+        {
+            int depth = 2 + (int)(randomU64() % 5);
+            for (int d = 0; d < depth; d++)
+                fprintf(fp, "/%s", dirs[randomU64() % (d < 2 ? 4 : 16)]);
+            fprintf(fp, "/file%05d.%s\n", (int)(randomU64() % 100000), exts[randomU64() % 6]);
+        }
+        else
+            fprintf(fp, "user-%08x-%04x\n", (unsigned)(randomU64() >> 40), (unsigned)(randomU64() & 0xFFFF));
+    }
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+void benchmarkStrings(int n, const char *file)
+{
+    const char *generated = "string_bench_input.txt";
+    const char *setNames[] = {"paths", "ids", file};
+    int numSets = file ? 3 : 2;
+
+    FILE *fp = fopen("string_sorting_times.dat", "w");
+    fprintf(fp, "# set lines bytes avg_lcp qsort_strcmp");
+    printf("%-10s %10s %12s %8s %13s", "data", "lines", "bytes", "avg LCP", "qsort_strcmp");
+    for (int a = 0; a < numStringSortAlgorithms; a++)
+    {
+        fprintf(fp, " %s", stringSortAlgorithms[a].name);
+        printf(" %13s", stringSortAlgorithms[a].name);
+    }
+    fprintf(fp, "\n");
+    printf("\n");
+
+    for (int s = 0; s < numSets; s++)
+    {
+        const char *path = s < 2 ? generated : file;
+        if (s < 2 && writeStringBenchFile(path, n, s) != 0)
+            continue;
+        StringSet set;
+        int status = loadStringFile(path, &set);
+        if (s < 2)
+            remove(path);
+        if (status != 0)
+            continue;
+        int lines = set.count;
+
+        // Baseline: an array of C string pointers sorted by qsort and strcmp
+        char **pointers = (char **)malloc((lines > 0 ? lines : 1) * sizeof(char *));
+        char **sortedPointers = (char **)malloc((lines > 0 ? lines : 1) * sizeof(char *));
+        for (int i = 0; i < lines; i++)
+            pointers[i] = set.arena + set.refs[i].offset;
+        double baseline = INFINITY;
+        for (int rep = 0; rep < 3; rep++)
+        {
+            memcpy(sortedPointers, pointers, lines * sizeof(char *));
+            double start = wallTime();
+            qsort(sortedPointers, lines, sizeof(char *), compareCStrings);
+            double elapsed = wallTime() - start;
+            if (elapsed < baseline)
+                baseline = elapsed;
+        }
+
+        StringRef *refs = (StringRef *)malloc((lines > 0 ? lines : 1) * sizeof(StringRef));
+        uint32_t *lcp = (uint32_t *)malloc((lines > 0 ? lines : 1) * sizeof(uint32_t));
+        memcpy(refs, set.refs, lines * sizeof(StringRef));
+        stringRadixSortLcp(set.arena, refs, lines, lcp);
+        double lcpSum = 0.0;
+        for (int i = 1; i < lines; i++)
+            lcpSum += lcp[i];
+        double avgLcp = lines > 1 ? lcpSum / (lines - 1) : 0.0;
+
+        printf("%-10s %10d %12zu %8.1f %13.4f", setNames[s], lines, set.size, avgLcp, baseline);
+        fprintf(fp, "%s %d %zu %f %f", setNames[s], lines, set.size, avgLcp, baseline);
+        for (int a = 0; a < numStringSortAlgorithms; a++)
+        {
+            double best = INFINITY;
+            for (int rep = 0; rep < 3; rep++)
+            {
+                memcpy(refs, set.refs, lines * sizeof(StringRef));
+                double start = wallTime();
+                stringSortAlgorithms[a].sort(set.arena, refs, lines);
+                double elapsed = wallTime() - start;
+                if (elapsed < best)
+                    best = elapsed;
+            }
+            for (int i = 0; i < lines; i++)
+                if (strcmp(set.arena + refs[i].offset, sortedPointers[i]) != 0)
+                {
+                    printf("\nWarning: %s output differs from qsort at line %d\n", stringSortAlgorithms[a].name, i);
+                    break;
+                }
+            printf(" %13.4f", best);
+            fprintf(fp, " %f", best);
+        }
+        printf("\n");
+        fprintf(fp, "\n");
+
+        free(lcp);
+        free(refs);
+        free(sortedPointers);
+        free(pointers);
+        freeStringSet(&set);
+    }
+
+    fclose(fp);
+    printf("Data saved to string_sorting_times.dat\n");
+}
+
+// Benchmark Statistics
+// measureSorts() times several algorithms on one input. Every call sorts a fresh copy of the
+// pristine input, and only the sort itself is timed. A warm-up call is discarded. The calls per
+// sample are then raised until one sample takes STATS_MIN_SAMPLE_SECONDS, so short sorts are not
+// lost in timer resolution. The number of samples fits STATS_BUDGET_SECONDS, within
+// STATS_MIN_SAMPLES..STATS_MAX_SAMPLES. Interleaved mode takes one sample of each algorithm per
+// round, in a new random order every round, so drift (frequency, heat, other load) spreads over
+// all of them instead of hitting whichever ran last. Serial sorts run pinned to one core;
+// parallel ones get the whole affinity mask back. Each result has the mean, median, standard
+// deviation, a 95% confidence interval of the mean (Student's t), and the number of samples
+// outside Tukey's fences (1.5 IQR beyond the quartiles).
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#define STATS_MIN_SAMPLE_SECONDS 0.01
+#define STATS_BUDGET_SECONDS 0.5
+#define STATS_MIN_SAMPLES 3
+#define STATS_MAX_SAMPLES 30
+#define STATS_MAX_CALLS 1000000
+
+typedef struct
+{
+    int samples, calls, outliers;
+    double mean, median, stddev, ciLow, ciHigh; // seconds per call
+    double sample[STATS_MAX_SAMPLES];
+} TimingStats;
+
+// Two-sided 95% critical value of Student's t; fractional df round down (wider interval)
+double tCritical95(double df)
+{
+    static const double table[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                     2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                     2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (!(df >= 1.0))
+        return INFINITY;
+    if (df < 31.0)
+        return table[(int)df - 1];
+    return df < 40.0 ? 2.042 : df < 60.0 ? 2.021 : df < 120.0 ? 2.000 : df < 1e6 ? 1.980 : 1.960;
+}
+
+// Welch's t-test of two means; returns 1 when they differ at the 5% level, with t and the
+// Welch-Satterthwaite degrees of freedom in *t and *df (NAN when either side has one sample)
+int welchTest(double meanA, double sdA, int nA, double meanB, double sdB, int nB, double *t, double *df)
+{
+    *t = *df = NAN;
+    if (nA < 2 || nB < 2 || isnan(sdA) || isnan(sdB))
+        return 0;
+    double va = sdA * sdA / nA, vb = sdB * sdB / nB;
+    if (va + vb == 0.0)
+        return meanA != meanB;
+    *t = (meanB - meanA) / sqrt(va + vb);
+    *df = (va + vb) * (va + vb) / (va * va / (nA - 1) + vb * vb / (nB - 1));
+    return fabs(*t) > tCritical95(*df);
+}
+
+// Fills in the summary of st->sample[0..samples)
+void computeTimingStats(TimingStats *st)
+{
+    int n = st->samples;
+    double sorted[STATS_MAX_SAMPLES], sum = 0.0, squares = 0.0;
+    for (int i = 0; i < n; i++)
+    {
+        double x = st->sample[i];
+        int j = i;
+        for (; j > 0 && sorted[j - 1] > x; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = x;
+        sum += x;
+    }
+    st->mean = sum / n;
+    for (int i = 0; i < n; i++)
+        squares += (st->sample[i] - st->mean) * (st->sample[i] - st->mean);
+    st->stddev = n > 1 ? sqrt(squares / (n - 1)) : NAN;
+    double half = n > 1 ? tCritical95(n - 1) * st->stddev / sqrt(n) : NAN;
+    st->ciLow = st->mean - half;
+    st->ciHigh = st->mean + half;
+
+    // Quantiles by linear interpolation between order statistics
+    double q[3];
+    for (int k = 0; k < 3; k++)
+    {
+        double pos = (n - 1) * 0.25 * (k + 1);
+        int i = (int)pos;
+        q[k] = i + 1 < n ? sorted[i] + (pos - i) * (sorted[i + 1] - sorted[i]) : sorted[i];
+    }
+    st->median = q[1];
+    double fence = 1.5 * (q[2] - q[0]);
+    st->outliers = 0;
+    for (int i = 0; i < n; i++)
+        st->outliers += sorted[i] < q[0] - fence || sorted[i] > q[2] + fence;
+}
+
+// Benchmark Affinity
+// benchCore is the core serial sorts run on: -1 turns pinning off, -2 picks the last core of the
+// mask the process started with (core 0 usually takes more interrupts).
+int benchCore = -2;
+
+// Pins the calling thread to benchCore, or gives it back the original mask when pinned is 0
+void benchPin(int pinned)
+{
+#ifdef __linux__
+    static cpu_set_t original;
+    static int saved = 0, current = -1;
+    if (!saved)
+    {
+        if (sched_getaffinity(0, sizeof(original), &original) != 0)
+            return;
+        saved = 1;
+        for (int c = CPU_SETSIZE - 1; c >= 0 && benchCore == -2; c--)
+            if (CPU_ISSET(c, &original))
+                benchCore = c;
+    }
+    if (benchCore < 0 || pinned == current)
+        return;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(benchCore, &mask);
+    if (sched_setaffinity(0, sizeof(cpu_set_t), pinned ? &mask : &original) == 0)
+        current = pinned;
+#else
+    (void)pinned;
+#endif
+}
+
+// Sum of the sort times of calls calls, each on a fresh copy of src
+double timeSortCalls(void (*sort)(int[], int), const int src[], int temp[], int n, int calls)
+{
+    double elapsed = 0.0;
+    for (int c = 0; c < calls; c++)
+    {
+        memcpy(temp, src, n * sizeof(int));
+        double start = wallTime();
+        sort(temp, n);
+        elapsed += wallTime() - start;
+    }
+    return elapsed;
+}
+
+// Measures count sorts on the same n elements of src; temp is scratch of n elements.
+// parallel[a] (may be NULL) marks sorts that start threads and must not run pinned.
+void measureSorts(void (*sorts[])(int[], int), const int parallel[], int count, const int src[], int temp[], int n,
+                  int interleaved, TimingStats stats[])
+{
+    int rounds = 0;
+    for (int a = 0; a < count; a++)
+    {
+        benchPin(!(parallel && parallel[a]));
+        TimingStats *st = &stats[a];
+        st->calls = 1;
+        double t = timeSortCalls(sorts[a], src, temp, n, 1);
+        while (t < STATS_MIN_SAMPLE_SECONDS && st->calls < STATS_MAX_CALLS)
+        {
+            double grow = t > 0.0 ? 1.25 * STATS_MIN_SAMPLE_SECONDS / t : 100.0;
+            st->calls = (int)fmin(st->calls * fmin(fmax(grow, 2.0), 100.0), STATS_MAX_CALLS);
+            t = timeSortCalls(sorts[a], src, temp, n, st->calls);
+        }
+        st->samples = (int)fmin(fmax(STATS_BUDGET_SECONDS / t, STATS_MIN_SAMPLES), STATS_MAX_SAMPLES);
+        if (st->samples > rounds)
+            rounds = st->samples;
+    }
+
+    int *order = (int *)malloc(count * sizeof(int));
+    for (int a = 0; a < count; a++)
+        order[a] = a;
+    if (interleaved)
+    {
+        for (int r = 0; r < rounds; r++)
+        {
+            for (int i = count - 1; i > 0; i--)
+            {
+                int j = (int)(randomU64() % (uint64_t)(i + 1));
+                int swap = order[i];
+                order[i] = order[j];
+                order[j] = swap;
+            }
+            for (int i = 0; i < count; i++)
+            {
+                TimingStats *st = &stats[order[i]];
+                if (r >= st->samples)
+                    continue;
+                benchPin(!(parallel && parallel[order[i]]));
+                st->sample[r] = timeSortCalls(sorts[order[i]], src, temp, n, st->calls) / st->calls;
+            }
+        }
+    }
+    else
+    {
+        for (int a = 0; a < count; a++)
+        {
+            benchPin(!(parallel && parallel[a]));
+            for (int r = 0; r < stats[a].samples; r++)
+                stats[a].sample[r] = timeSortCalls(sorts[a], src, temp, n, stats[a].calls) / stats[a].calls;
+        }
+    }
+    benchPin(0);
+    for (int a = 0; a < count; a++)
+        computeTimingStats(&stats[a]);
+    free(order);
+}
+
+void printTimingHeader(void)
+{
+    printf("%-20s %10s %12s %9s %12s %12s %8s\n", "algorithm", "n", "mean (s)", "95% CI", "median (s)", "samples",
+           "outliers");
+}
+
+void printTimingStats(const char *name, int n, const TimingStats *st)
+{
+    char runs[32];
+    snprintf(runs, sizeof(runs), "%d x %d", st->samples, st->calls);
+    printf("%-20s %10d %12.4g %8.2f%% %12.4g %12s %8d%s\n", name, n, st->mean,
+           (st->ciHigh - st->mean) / st->mean * 100.0, st->median, runs, st->outliers,
+           st->outliers * 10 > st->samples ? "  NOISY" : "");
+}
+
+// Results Store
+// Benchmarks append one row per measurement to RESULTS_STORE_FILE, a CSV file that is never
+// rewritten. Every row carries the schema version, a run id, the host, compiler, build flags,
+// commit and seed, so runs of different builds can sit side by side in one store and be
+// compared later by --report. Build with -DSORT_BUILD_FLAGS="\"$CFLAGS\"" and
+// -DSORT_GIT_COMMIT="\"$(git rev-parse --short HEAD)\"" to fill in the last two.
+// Schema 2 added the TimingStats columns after seconds (the mean); schema 1 rows end at seconds
+// and are still read, as single samples.
+#define RESULTS_STORE_FILE "sort_results.csv"
+#define RESULTS_SCHEMA 2
+#define RESULTS_SCHEMA1_FIELDS 12
+#define RESULTS_FIELDS 19
+#define RESULTS_HEADER "schema,run,time,host,compiler,flags,commit,seed,benchmark,algorithm,n,seconds," \
+                       "stddev,samples,calls,ci_low,ci_high,median,outliers"
+
+#ifndef SORT_BUILD_FLAGS
+#define SORT_BUILD_FLAGS "unknown"
+#endif
+#define SORT_UNKNOWN_COMMIT "unknown"
+#ifndef SORT_GIT_COMMIT
+#define SORT_GIT_COMMIT SORT_UNKNOWN_COMMIT
+#endif
+#if defined(__clang__)
+#define SORT_COMPILER __VERSION__
+#elif defined(__GNUC__)
+#define SORT_COMPILER "gcc " __VERSION__
+#else
+#define SORT_COMPILER "unknown"
+#endif
+
+typedef struct
+{
+    char run[64];   // start time and pid, so ids of one host sort chronologically
+    char time[32];  // ISO 8601, UTC
+    char host[256];
+    uint64_t seed;
+    FILE *fp;
+} ResultsRun;
+
+// Writes s as one CSV field, quoted when it holds a comma, quote or newline
+void csvWriteField(FILE *fp, const char *s)
+{
+    if (strpbrk(s, ",\"\n") == NULL)
+    {
+        fputs(s, fp);
+        return;
+    }
+    fputc('"', fp);
+    for (; *s; s++)
+    {
+        if (*s == '"')
+            fputc('"', fp);
+        fputc(*s == '\n' ? ' ' : *s, fp);
+    }
+    fputc('"', fp);
+}
+
+// Splits one CSV line in place; returns the number of fields (at most max)
+int csvSplit(char *line, char *fields[], int max)
+{
+    int count = 0;
+    char *r = line;
+    while (count < max)
+    {
+        char *w = r;
+        fields[count++] = w;
+        if (*r == '"')
+        {
+            for (r++; *r; r++)
+            {
+                if (*r == '"' && r[1] == '"')
+                    r++;
+                else if (*r == '"')
+                {
+                    r++;
+                    break;
+                }
+                *w++ = *r;
+            }
+        }
+        while (*r && *r != ',' && *r != '\n' && *r != '\r')
+            *w++ = *r++;
+        int more = *r == ',';
+        *w = '\0';
+        if (!more)
+            break;
+        r++;
+    }
+    return count;
+}
+
+// Opens the store for appending and starts a run; returns 0, or -1 when the store cannot be written
+int resultsOpen(ResultsRun *run, const char *path, uint64_t seed)
+{
+    time_t now = time(NULL);
+    struct tm utc;
+    gmtime_r(&now, &utc);
+    strftime(run->time, sizeof(run->time), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    snprintf(run->run, sizeof(run->run), "%04d%02d%02d-%02d%02d%02d-%d", utc.tm_year + 1900, utc.tm_mon + 1,
+             utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec, (int)getpid());
+    strcpy(run->host, "unknown");
+    gethostname(run->host, sizeof(run->host) - 1);
+    run->seed = seed;
+
+    run->fp = fopen(path, "a");
+    if (run->fp == NULL)
+    {
+        printf("Error opening %s.\n", path);
+        return -1;
+    }
+    if (ftell(run->fp) == 0)
+        fprintf(run->fp, "%s\n", RESULTS_HEADER);
+    return 0;
+}
+
+void resultsAppend(ResultsRun *run, const char *benchmark, const char *algorithm, int n, const TimingStats *st)
+{
+    if (run->fp == NULL)
+        return;
+    fprintf(run->fp, "%d,%s,%s,", RESULTS_SCHEMA, run->run, run->time);
+    const char *text[] = {run->host, SORT_COMPILER, SORT_BUILD_FLAGS, SORT_GIT_COMMIT};
+    for (int i = 0; i < 4; i++)
+    {
+        csvWriteField(run->fp, text[i]);
+        fputc(',', run->fp);
+    }
+    fprintf(run->fp, "%llu,", (unsigned long long)run->seed);
+    csvWriteField(run->fp, benchmark);
+    fputc(',', run->fp);
+    csvWriteField(run->fp, algorithm);
+    fprintf(run->fp, ",%d,%.9g,%.9g,%d,%d,%.9g,%.9g,%.9g,%d\n", n, st->mean, st->stddev, st->samples, st->calls,
+            st->ciLow, st->ciHigh, st->median, st->outliers);
+}
+
+void resultsClose(ResultsRun *run)
+{
+    if (run->fp)
+        fclose(run->fp);
+    run->fp = NULL;
+}
+
+// Every table algorithm on random input of doubling sizes up to maxN, through measureSorts;
+// prints the statistics and appends them to the results store as benchmark "stats". The input
+// of each size depends only on seed and n, so builds compared later have sorted the same data.
+// Returns 0, or -1 when the results could not be stored.
+int benchmarkStatistics(int maxN, int interleaved, uint64_t seed)
+{
+    if (maxN < 1000)
+        maxN = 1000;
+    int *src = (int *)malloc(maxN * sizeof(int));
+    int *temp = (int *)malloc(maxN * sizeof(int));
+    void (**sorts)(int[], int) = (void (**)(int[], int))malloc(numSortAlgorithms * sizeof(sorts[0]));
+    int *parallel = (int *)malloc(numSortAlgorithms * sizeof(int));
+    int *which = (int *)malloc(numSortAlgorithms * sizeof(int));
+    TimingStats *stats = (TimingStats *)malloc(numSortAlgorithms * sizeof(TimingStats));
+    ResultsRun results;
+    int status = resultsOpen(&results, RESULTS_STORE_FILE, seed);
+
+    benchPin(1);
+    printf("Seed %llu, %s order, serial sorts ", (unsigned long long)seed,
+           interleaved ? "interleaved random" : "sequential");
+    if (benchCore < 0)
+        printf("unpinned\n");
+    else
+        printf("pinned to core %d\n", benchCore);
+    benchPin(0);
+    printTimingHeader();
+    for (int n = 1000; n <= maxN; n *= 2)
+    {
+        int count = 0;
+        rngState = seed + n;
+        fillDistribution(src, n, DIST_RANDOM);
+        for (int a = 0; a < numSortAlgorithms; a++)
+        {
+            void (*sort)(int[], int) = sortAlgorithms[a].sort;
+            if (tooLargeFor(sort, n))
+                continue;
+            which[count] = a;
+            sorts[count] = sort;
+            parallel[count++] = isParallelSort(sort);
+        }
+        measureSorts(sorts, parallel, count, src, temp, n, interleaved, stats);
+        for (int i = 0; i < count; i++)
+        {
+            printTimingStats(sortAlgorithms[which[i]].name, n, &stats[i]);
+            resultsAppend(&results, "stats", sortAlgorithms[which[i]].name, n, &stats[i]);
+        }
+        if (n > maxN / 2) // n * 2 could overflow
+            break;
+    }
+    resultsClose(&results);
+    if (status == 0)
+        printf("Results appended to %s\n", RESULTS_STORE_FILE);
+    else
+        printf("Error: results not stored, %s could not be opened.\n", RESULTS_STORE_FILE);
+    free(stats);
+    free(which);
+    free(parallel);
+    free(sorts);
+    free(src);
+    free(temp);
+    return status;
+}
+
+// Test Suite
+// --verify fuzzes every table algorithm (plus autoSort) on edge cases and random sizes and
+// distributions. Each run sorts a copy that has guard words on both sides and checks that the
+// result is sorted, that its multiset hash matches the input's, and that the guards are intact.
+// The threaded entry points run with VERIFY_THREADS threads whatever the core count, every sort
+// also gets a few inputs of VERIFY_PARALLEL_N keys (above all the parallel thresholds), and the
+// parallel select, top-k and partial sort are checked against a sorted copy. It also checks
+// the declared stability of the record sorts.
+// --regress times every algorithm at fixed sizes and compares against the baseline file
+// recorded on this host, failing when one is slower by more than the tolerance.
+#define VERIFY_GUARD 0x5A5A5A5A
+#define VERIFY_MAX_N (1 << 17)
+#define VERIFY_QUADRATIC_MAX_N 3000
+#define VERIFY_THREADS 4
+#define VERIFY_PARALLEL_N (PARALLEL_SELECT_MIN + 4099)
+#define REGRESS_BASELINE_FILE "sort_baseline.dat"
+#define REGRESS_TOLERANCE 10.0
+
+// Order-independent: a sum of mixed values, so any permutation hashes the same
+uint64_t multisetHash(const int arr[], int n)
+{
+    uint64_t sum = (uint64_t)n;
+    for (int i = 0; i < n; i++)
+    {
+        uint64_t z = (uint64_t)(uint32_t)arr[i] + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        sum += z ^ (z >> 31);
+    }
+    return sum;
+}
+
+// Edge-case inputs: c selects the pattern, n its size
+enum
+{
+    EDGE_EXTREMES,   // INT_MIN and INT_MAX mixed with random values
+    EDGE_ALTERNATING, // INT_MAX, INT_MIN, INT_MAX, ...
+    EDGE_ALL_EQUAL,
+    EDGE_TWO_VALUES,
+    EDGE_ALL_MIN,
+    EDGE_COUNT
+};
+
+void fillEdgeCase(int arr[], int n, int c)
+{
+    for (int i = 0; i < n; i++)
+    {
+        switch (c)
+        {
+        case EDGE_EXTREMES:
+        {
+            uint64_t r = randomU64();
+            arr[i] = r % 3 == 0 ? INT_MIN : r % 3 == 1 ? INT_MAX : (int)(uint32_t)(r >> 32);
+            break;
+        }
+        case EDGE_ALTERNATING: arr[i] = i % 2 ? INT_MIN : INT_MAX; break;
+        case EDGE_ALL_EQUAL: arr[i] = 42; break;
+        case EDGE_TWO_VALUES: arr[i] = (int)(randomU64() % 2) - 1; break;
+        default: arr[i] = INT_MIN; break;
+        }
+    }
+}
+
+// Sorts a guarded copy of src; returns NULL on success or a description of the failure
+const char *verifySortRun(void (*sort)(int[], int), const int src[], int n, int guarded[])
+{
+    guarded[0] = VERIFY_GUARD;
+    guarded[n + 1] = VERIFY_GUARD;
+    int *arr = guarded + 1;
+    memcpy(arr, src, n * sizeof(int));
+    sort(arr, n);
+    if (guarded[0] != VERIFY_GUARD || guarded[n + 1] != VERIFY_GUARD)
+        return "wrote outside the array";
+    if (!isSorted(arr, n))
+        return "not sorted";
+    if (multisetHash(arr, n) != multisetHash(src, n))
+        return "not a permutation of the input";
+    return NULL;
+}
+
+void verifyParallelRadixSort(int arr[], int n) { parallelRadixSort(arr, n, VERIFY_THREADS); }
+void verifyParallelMergeSort(int arr[], int n) { parallelMergeSort(arr, n, VERIFY_THREADS); }
+void verifyParallelSampleSort(int arr[], int n) { parallelSampleSort(arr, n, VERIFY_THREADS); }
+
+void verifyParallelCountingSort(int arr[], int n)
+{
+    if (!countingSortRange(arr, n, VERIFY_THREADS))
+        radixSort(arr, n);
+}
+
+// Checked after the table: autoSort and the threaded entry points with a fixed thread count
+SortAlgorithm verifyExtraSorts[] = {
+    {"Auto Sort", autoSort, 0},
+    {"Parallel Radix Sort", verifyParallelRadixSort, 1},
+    {"Parallel Merge Sort", verifyParallelMergeSort, 1},
+    {"Parallel Samplesort", verifyParallelSampleSort, 0},
+    {"Parallel Counting", verifyParallelCountingSort, 0},
+};
+int numVerifyExtraSorts = sizeof(verifyExtraSorts) / sizeof(verifyExtraSorts[0]);
+
+// Checks parallelSelect, parallelTopK and parallelPartialSort at rank k against sorted, the
+// sorted copy of src; returns NULL on success or a description of the failure
+const char *verifySelectRun(const int src[], int n, int k, const int sorted[], int work[])
+{
+    if (parallelSelect(src, n, k, VERIFY_THREADS) != sorted[k])
+        return "parallelSelect returned the wrong value";
+    int count = parallelTopK(src, n, k + 1, work, VERIFY_THREADS);
+    if (count != k + 1 || memcmp(work, sorted, count * sizeof(int)) != 0)
+        return "parallelTopK returned the wrong elements";
+    memcpy(work, src, n * sizeof(int));
+    parallelPartialSort(work, n, k + 1, VERIFY_THREADS);
+    if (memcmp(work, sorted, (k + 1) * sizeof(int)) != 0)
+        return "parallelPartialSort did not put the smallest elements in front";
+    if (multisetHash(work, n) != multisetHash(src, n))
+        return "parallelPartialSort did not keep a permutation of the input";
+    return NULL;
+}
+
+// Fills src with case c (an edge case below EDGE_COUNT, a distribution above)
+void fillVerifyCase(int src[], int n, int c)
+{
+    if (c < EDGE_COUNT)
+        fillEdgeCase(src, n, c);
+    else
+        fillDistribution(src, n, c - EDGE_COUNT);
+}
+
+// Returns the number of failures
+int runVerification(int iterations, uint64_t seed)
+{
+    int numSorts = numSortAlgorithms + numVerifyExtraSorts;
+    int failures = 0, runs = 0;
+    int *src = (int *)malloc(VERIFY_PARALLEL_N * sizeof(int));
+    int *guarded = (int *)malloc((VERIFY_PARALLEL_N + 2) * sizeof(int));
+    int *sorted = (int *)malloc(VERIFY_PARALLEL_N * sizeof(int));
+    // Sizes around the cutoffs of the hybrid sorts (insertion, SIMD blocks, merge runs)
+    int edgeSizes[] = {0, 1, 2, 3, 7, 8, 15, 16, 17, 24, 25, 31, 32, 33, 63, 64, 65, 129, 1000};
+    int numEdgeSizes = sizeof(edgeSizes) / sizeof(edgeSizes[0]);
+    // Wide keys, and duplicates in a narrow range (counting sort's parallel path). Fewer distinct
+    // keys would make Quick Sort's partition quadratic at this size.
+    int largeCases[] = {EDGE_COUNT + DIST_RANDOM, EDGE_COUNT + DIST_MOD1000};
+    int numLargeCases = sizeof(largeCases) / sizeof(largeCases[0]);
+
+    printf("Verifying %d algorithms, %d fuzz iterations each, seed %llu\n", numSorts, iterations,
+           (unsigned long long)seed);
+    for (int a = 0; a < numSorts; a++)
+    {
+        const SortAlgorithm *entry =
+            a < numSortAlgorithms ? &sortAlgorithms[a] : &verifyExtraSorts[a - numSortAlgorithms];
+        const char *name = entry->name;
+        void (*sort)(int[], int) = entry->sort;
+        int maxN = isQuadraticSort(sort) ? VERIFY_QUADRATIC_MAX_N : VERIFY_MAX_N;
+        int before = failures;
+        rngState = seed + a;
+
+        for (int e = 0; e < numEdgeSizes; e++)
+        {
+            for (int c = 0; c < EDGE_COUNT + DIST_COUNT; c++)
+            {
+                int n = edgeSizes[e];
+                fillVerifyCase(src, n, c);
+                const char *error = verifySortRun(sort, src, n, guarded);
+                runs++;
+                if (error)
+                {
+                    failures++;
+                    printf("FAIL %s: %s (n = %d, %s %s)\n", name, error, n, c < EDGE_COUNT ? "edge case" : "distribution",
+                           c < EDGE_COUNT ? "" : distributionNames[c - EDGE_COUNT]);
+                }
+            }
+        }
+
+        for (int it = 0; it < iterations; it++)
+        {
+            // Log-uniform sizes so small and large inputs are both common
+            int n = (int)exp(log((double)maxN) * (randomU64() % 1000) / 1000.0);
+            int c = (int)(randomU64() % (EDGE_COUNT + DIST_COUNT));
+            uint64_t caseState = rngState;
+            fillVerifyCase(src, n, c);
+            const char *error = verifySortRun(sort, src, n, guarded);
+            runs++;
+            if (error)
+            {
+                failures++;
+                printf("FAIL %s: %s (n = %d, case %d, rng state %llu)\n", name, error, n, c,
+                       (unsigned long long)caseState);
+            }
+        }
+
+        for (int l = 0; l < numLargeCases && !tooLargeFor(sort, VERIFY_PARALLEL_N); l++)
+        {
+            fillVerifyCase(src, VERIFY_PARALLEL_N, largeCases[l]);
+            const char *error = verifySortRun(sort, src, VERIFY_PARALLEL_N, guarded);
+            runs++;
+            if (error)
+            {
+                failures++;
+                printf("FAIL %s: %s (n = %d, case %d)\n", name, error, VERIFY_PARALLEL_N, largeCases[l]);
+            }
+        }
+        printf("  %-20s %s\n", name, failures == before ? "ok" : "FAILED");
+    }
+
+    int selectSizes[] = {1, 2, 1000, VERIFY_PARALLEL_N};
+    int numSelectSizes = sizeof(selectSizes) / sizeof(selectSizes[0]);
+    int selectCases[] = {EDGE_COUNT + DIST_RANDOM, EDGE_COUNT + DIST_FEW_UNIQUE, EDGE_TWO_VALUES, EDGE_EXTREMES};
+    int numSelectCases = sizeof(selectCases) / sizeof(selectCases[0]);
+    int before = failures;
+    rngState = seed + numSorts;
+    for (int z = 0; z < numSelectSizes; z++)
+    {
+        int n = selectSizes[z];
+        for (int c = 0; c < numSelectCases; c++)
+        {
+            fillVerifyCase(src, n, selectCases[c]);
+            memcpy(sorted, src, n * sizeof(int));
+            radixSort(sorted, n);
+            int ranks[] = {0, n / 2, n - 1, (int)(randomU64() % n)};
+            for (int r = 0; r < 4; r++)
+            {
+                const char *error = verifySelectRun(src, n, ranks[r], sorted, guarded);
+                runs++;
+                if (error)
+                {
+                    failures++;
+                    printf("FAIL %s (n = %d, k = %d, case %d)\n", error, n, ranks[r], selectCases[c]);
+                }
+            }
+        }
+    }
+    printf("  %-20s %s\n", "Parallel selection", failures == before ? "ok" : "FAILED");
+
+    for (int a = 0; a < numTaggedSortAlgorithms; a++)
+    {
+        int observed = verifyStability(taggedSortAlgorithms[a].sort, VERIFY_QUADRATIC_MAX_N, 50);
+        runs++;
+        if (observed < 0 || (taggedSortAlgorithms[a].stable && observed != 1))
+        {
+            failures++;
+            printf("FAIL %s (records): %s\n", taggedSortAlgorithms[a].name,
+                   observed < 0 ? "not a sorted permutation" : "declared stable but reordered equal keys");
+        }
+    }
+
+    free(src);
+    free(guarded);
+    free(sorted);
+    printf("%d runs, %d failures\n", runs, failures);
+    return failures;
+}
+
+// Times every algorithm at fixed sizes and seeds with measureSorts. With record set, writes the
+// baseline; otherwise compares with it. A change above the tolerance counts as a regression when
+// Welch's t-test finds it significant (baselines from before the statistics have no spread and
+// are compared on the mean alone). Returns the number of regressions (or -1 on error).
+int runRegression(const char *path, double tolerancePercent, int record)
+{
+    int sizes[] = {10000, 1000000};
+    int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+
+    TimingStats *baseline = (TimingStats *)malloc(numSortAlgorithms * numSizes * sizeof(TimingStats));
+    for (int i = 0; i < numSortAlgorithms * numSizes; i++)
+    {
+        baseline[i].mean = baseline[i].stddev = NAN;
+        baseline[i].samples = 0;
+    }
+
+    FILE *fp = record ? NULL : fopen(path, "r");
+    if (fp == NULL && !record)
+    {
+        printf("Error: no baseline %s; record one with --regress-record\n", path);
+        free(baseline);
+        return -1;
+    }
+    if (fp)
+    {
+        char line[512], name[256], baseHost[256] = "";
+        int n, samples;
+        double seconds, stddev;
+        while (fgets(line, sizeof(line), fp) != NULL)
+        {
+            if (sscanf(line, "# host %255s", baseHost) == 1)
+                continue;
+            if (line[0] == '#')
+                continue;
+            if (sscanf(line, "%d %lf %lf %d %255[^\n]", &n, &seconds, &stddev, &samples, name) != 5)
+            {
+                if (sscanf(line, "%d %lf %255[^\n]", &n, &seconds, name) != 3)
+                    continue;
+                stddev = NAN;
+                samples = 1;
+            }
+            for (int a = 0; a < numSortAlgorithms; a++)
+                for (int z = 0; z < numSizes; z++)
+                    if (sizes[z] == n && strcmp(sortAlgorithms[a].name, name) == 0)
+                    {
+                        baseline[a * numSizes + z].mean = seconds;
+                        baseline[a * numSizes + z].stddev = stddev;
+                        baseline[a * numSizes + z].samples = samples;
+                    }
+        }
+        if (strcmp(baseHost, host) != 0)
+        {
+            printf("Error: baseline %s was recorded on host %s, this is %s; rerun with --regress-record\n", path,
+                   baseHost, host);
+            fclose(fp);
+            free(baseline);
+            return -1;
+        }
+        fclose(fp);
+    }
+
+    int *src = (int *)malloc(sizes[numSizes - 1] * sizeof(int));
+    int *temp = (int *)malloc(sizes[numSizes - 1] * sizeof(int));
+    FILE *out = NULL;
+    if (record)
+    {
+        out = fopen(path, "w");
+        if (out == NULL)
+        {
+            printf("Error: cannot write %s\n", path);
+            free(baseline);
+            free(src);
+            free(temp);
+            return -1;
+        }
+        fprintf(out, "# host %s\n# n seconds stddev samples name\n", host);
+    }
+
+    void (**sorts)(int[], int) = (void (**)(int[], int))malloc(numSortAlgorithms * sizeof(sorts[0]));
+    int *parallel = (int *)malloc(numSortAlgorithms * sizeof(int));
+    int *which = (int *)malloc(numSortAlgorithms * sizeof(int));
+    TimingStats *stats = (TimingStats *)malloc(numSortAlgorithms * sizeof(TimingStats));
+    ResultsRun results;
+    resultsOpen(&results, RESULTS_STORE_FILE, 12345);
+    int regressions = 0;
+    printf("%-20s %10s %12s %9s %12s %9s %6s\n", "algorithm", "n", "seconds", "95% CI", "baseline", "change",
+           "p<0.05");
+    for (int z = 0; z < numSizes; z++)
+    {
+        int n = sizes[z], count = 0;
+        rngState = 12345;
+        fillDistribution(src, n, DIST_RANDOM);
+        for (int a = 0; a < numSortAlgorithms; a++)
+        {
+            void (*sort)(int[], int) = sortAlgorithms[a].sort;
+            if (tooLargeFor(sort, n))
+                continue;
+            which[count] = a;
+            sorts[count] = sort;
+            parallel[count++] = isParallelSort(sort);
+        }
+        measureSorts(sorts, parallel, count, src, temp, n, 1, stats);
+
+        for (int i = 0; i < count; i++)
+        {
+            int a = which[i];
+            const TimingStats *st = &stats[i], *base = &baseline[a * numSizes + z];
+            double change = (st->mean / base->mean - 1.0) * 100.0, t, df;
+            int significant = welchTest(base->mean, base->stddev, base->samples, st->mean, st->stddev, st->samples,
+                                        &t, &df);
+            int regressed = !record && !isnan(base->mean) && change > tolerancePercent && (significant || isnan(t));
+            regressions += regressed;
+            printf("%-20s %10d %12.4g %8.2f%% %12.4g %8.1f%% %6s%s\n", sortAlgorithms[a].name, n, st->mean,
+                   (st->ciHigh - st->mean) / st->mean * 100.0, base->mean, record ? 0.0 : change,
+                   isnan(t) ? "n/a" : significant ? "yes" : "no", regressed ? "  REGRESSION" : "");
+            if (out)
+                fprintf(out, "%d %.9g %.9g %d %s\n", n, st->mean, st->stddev, st->samples, sortAlgorithms[a].name);
+            resultsAppend(&results, "regress", sortAlgorithms[a].name, n, st);
+        }
+    }
+    resultsClose(&results);
+
+    if (out)
+    {
+        fclose(out);
+        printf("Baseline saved to %s\n", path);
+    }
+    else
+        printf("%d regressions above %.1f%%\n", regressions, tolerancePercent);
+    free(stats);
+    free(which);
+    free(parallel);
+    free(sorts);
+    free(baseline);
+    free(src);
+    free(temp);
+    return regressions;
+}
+
+// Reports
+// --report reads the results store and writes a gnuplot data file and script that render SVG
+// charts without a display: time against n for every algorithm of the selected runs, and with
+// two runs also the change of the second against the first. A run is selected by its run id,
+// by commit (every run of that build, samples pooled per size), or as "latest". Nothing here starts
+// gnuplot, so a benchmark never waits on a plot window; render with "gnuplot <prefix>.gp".
+// Times are plotted with their confidence intervals, and a change between two runs only counts
+// as a regression when Welch's t-test finds it significant.
+typedef struct
+{
+    char run[64], time[32], host[256], compiler[128], flags[256], commit[64];
+    unsigned long long seed;
+    char benchmark[32], algorithm[64];
+    int n, samples;
+    double seconds, stddev, ciLow, ciHigh;
+} ResultRow;
+
+typedef struct
+{
+    int selector;
+    const char *benchmark, *algorithm;
+    int count, capacity;
+    ResultRow *points; // ascending n
+} ReportSeries;
+
+// Rows of schema 1 and 2 in file order; returns NULL (and *count = 0) when there are none
+ResultRow *loadResults(const char *path, int *count)
+{
+    *count = 0;
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        printf("Error opening %s.\n", path);
+        return NULL;
+    }
+    int capacity = 1024, skipped = 0;
+    ResultRow *rows = (ResultRow *)malloc(capacity * sizeof(ResultRow));
+    char line[4096];
+    char *f[RESULTS_FIELDS];
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (strncmp(line, "schema,", 7) == 0 || line[0] == '\n')
+            continue;
+        int fields = csvSplit(line, f, RESULTS_FIELDS), schema = atoi(f[0]);
+        if (!(schema == 1 && fields == RESULTS_SCHEMA1_FIELDS) && !(schema == 2 && fields == RESULTS_FIELDS))
+        {
+            skipped++;
+            continue;
+        }
+        if (*count == capacity)
+        {
+            capacity *= 2;
+            rows = (ResultRow *)realloc(rows, capacity * sizeof(ResultRow));
+        }
+        ResultRow *r = &rows[(*count)++];
+        snprintf(r->run, sizeof(r->run), "%s", f[1]);
+        snprintf(r->time, sizeof(r->time), "%s", f[2]);
+        snprintf(r->host, sizeof(r->host), "%s", f[3]);
+        snprintf(r->compiler, sizeof(r->compiler), "%s", f[4]);
+        snprintf(r->flags, sizeof(r->flags), "%s", f[5]);
+        snprintf(r->commit, sizeof(r->commit), "%s", f[6]);
+        r->seed = strtoull(f[7], NULL, 10);
+        snprintf(r->benchmark, sizeof(r->benchmark), "%s", f[8]);
+        snprintf(r->algorithm, sizeof(r->algorithm), "%s", f[9]);
+        r->n = atoi(f[10]);
+        r->seconds = r->ciLow = r->ciHigh = atof(f[11]);
+        r->stddev = NAN;
+        r->samples = 1;
+        if (schema >= 2)
+        {
+            r->stddev = atof(f[12]);
+            r->samples = atoi(f[13]);
+            r->ciLow = atof(f[15]);
+            r->ciHigh = atof(f[16]);
+        }
+    }
+    fclose(fp);
+    if (skipped > 0)
+        printf("Skipped %d rows of %s that are malformed or newer than schema %d.\n", skipped, path, RESULTS_SCHEMA);
+    if (*count == 0)
+    {
+        free(rows);
+        return NULL;
+    }
+    return rows;
+}
+
+static inline int resultMatches(const ResultRow *r, const char *selector)
+{
+    return strcmp(r->run, selector) == 0 || strcmp(r->commit, selector) == 0;
+}
+
+// Merges row into the pooled point p: the mean over all samples of both, and their variance
+// (the spread within each row plus that between the row means)
+void poolResultRow(ResultRow *p, const ResultRow *row)
+{
+    const ResultRow *parts[] = {p, row};
+    int total = p->samples + row->samples;
+    double mean = (p->seconds * p->samples + row->seconds * row->samples) / total, squares = 0.0;
+    for (int i = 0; i < 2; i++)
+    {
+        double d = parts[i]->seconds - mean;
+        if (parts[i]->samples > 1 && !isnan(parts[i]->stddev))
+            squares += (parts[i]->samples - 1) * parts[i]->stddev * parts[i]->stddev;
+        squares += parts[i]->samples * d * d;
+    }
+    p->seconds = mean;
+    p->samples = total;
+    p->stddev = sqrt(squares / (total - 1));
+    double half = tCritical95(total - 1) * p->stddev / sqrt(total);
+    p->ciLow = mean - half;
+    p->ciHigh = mean + half;
+}
+
+// A size measured more than once (a commit selects every run of its build) becomes one pooled point
+void addSeriesPoint(ReportSeries *s, const ResultRow *row)
+{
+    for (int i = 0; i < s->count; i++)
+        if (s->points[i].n == row->n)
+        {
+            poolResultRow(&s->points[i], row);
+            return;
+        }
+    if (s->count == s->capacity)
+    {
+        s->capacity = s->capacity ? s->capacity * 2 : 16;
+        s->points = (ResultRow *)realloc(s->points, s->capacity * sizeof(ResultRow));
+    }
+    int i = s->count++;
+    for (; i > 0 && s->points[i - 1].n > row->n; i--)
+        s->points[i] = s->points[i - 1];
+    s->points[i] = *row;
+}
+
+// gnuplot titles are single-quoted; a quote inside one would end it
+void writePlotTitle(FILE *fp, const ReportSeries *s, const char *selectors[], int multipleRuns, int multipleBenchmarks)
+{
+    char title[256];
+    snprintf(title, sizeof(title), "%s%s%s%s%s%s", multipleBenchmarks ? s->benchmark : "",
+             multipleBenchmarks ? ": " : "", s->algorithm, multipleRuns ? " (" : "",
+             multipleRuns ? selectors[s->selector] : "", multipleRuns ? ")" : "");
+    for (char *c = title; *c; c++)
+        if (*c == '\'')
+            *c = '"';
+    fprintf(fp, "'%s'", title);
+}
+
+// Change of the second run (selector 1) against the first (selector 0) at every size both
+// measured: a table on stdout, one data block per algorithm in diff and a second plot in script.
+// Returns the number of sizes slower by more than REGRESS_TOLERANCE percent where Welch's t-test
+// rejects equal means at the 5% level (or cannot run, when a side has a single sample).
+int writeReportDiff(FILE *diff, const char *diffName, FILE *script, const char *prefix, const ReportSeries series[],
+                    int numSeries, const char *selectors[], int multipleBenchmarks)
+{
+    int regressions = 0, blocks = 0;
+    printf("%-20s %10s %12s %12s %9s %8s %6s\n", "algorithm", "n", selectors[0], selectors[1], "change", "t",
+           "p<0.05");
+    fprintf(script, "set output '%s_diff.svg'\n", prefix);
+    fprintf(script, "set title 'Change of %s against %s'\n", selectors[1], selectors[0]);
+    fprintf(script, "set ylabel 'Change (%%)'\nunset logscale y\nset logscale x 10\n");
+    fprintf(script, "plot 0 notitle linecolor rgb 'black', %g notitle dashtype 3 linecolor rgb 'red'",
+            (double)REGRESS_TOLERANCE);
+    for (int a = 0; a < numSeries; a++)
+    {
+        const ReportSeries *base = &series[a], *other = NULL;
+        for (int b = 0; b < numSeries && base->selector == 0; b++)
+            if (series[b].selector == 1 && strcmp(base->benchmark, series[b].benchmark) == 0 &&
+                strcmp(base->algorithm, series[b].algorithm) == 0)
+                other = &series[b];
+        if (other == NULL)
+            continue;
+
+        int points = 0;
+        for (int i = 0; i < base->count; i++)
+            for (int j = 0; j < other->count; j++)
+            {
+                const ResultRow *x = &base->points[i], *y = &other->points[j];
+                if (x->n != y->n || x->seconds <= 0.0)
+                    continue;
+                double change = (y->seconds / x->seconds - 1.0) * 100.0, t, df;
+                int significant =
+                    welchTest(x->seconds, x->stddev, x->samples, y->seconds, y->stddev, y->samples, &t, &df);
+                int regressed = change > REGRESS_TOLERANCE && (significant || isnan(t));
+                regressions += regressed;
+                if (points++ == 0)
+                    fprintf(diff, "%s# %s %s\n# n change%%\n", blocks ? "\n\n" : "", base->benchmark, base->algorithm);
+                fprintf(diff, "%d %.3f\n", x->n, change);
+                printf("%-20s %10d %12.4g %12.4g %8.1f%% %8.2f %6s%s\n", base->algorithm, x->n, x->seconds, y->seconds,
+                       change, t, isnan(t) ? "n/a" : significant ? "yes" : "no", regressed ? "  REGRESSION" : "");
+            }
+        if (points > 0)
+        {
+            fprintf(script, ", \\\n    '%s' index %d using 1:2 with linespoints linewidth 2 title ", diffName,
+                    blocks++);
+            writePlotTitle(script, base, selectors, 0, multipleBenchmarks);
+        }
+    }
+    fprintf(script, "\n");
+    printf("%d regressions above %.1f%%\n", regressions, (double)REGRESS_TOLERANCE);
+    return regressions;
+}
+
+// Writes <prefix>.dat, <prefix>.gp and, for two runs, <prefix>_diff.dat from the store rows of the
+// selected runs (only algorithm's when it is not NULL). Returns the number of sizes where the
+// second run is slower than the first by more than REGRESS_TOLERANCE percent, or -1 on error.
+int writeReport(const char *store, const char *selectors[], int numSelectors, const char *algorithm,
+                const char *prefix)
+{
+    int numRows;
+    ResultRow *rows = loadResults(store, &numRows);
+    if (rows == NULL)
+    {
+        printf("Error: %s holds no results.\n", store);
+        return -1;
+    }
+    const char *latest[] = {"latest"};
+    if (numSelectors == 0)
+    {
+        selectors = latest;
+        numSelectors = 1;
+    }
+    const char **resolved = (const char **)malloc(numSelectors * sizeof(const char *));
+    for (int s = 0; s < numSelectors; s++)
+    {
+        resolved[s] = strcmp(selectors[s], "latest") == 0 ? rows[numRows - 1].run : selectors[s];
+        // Builds without SORT_GIT_COMMIT all share this commit, so it would pool unrelated runs
+        if (strcmp(resolved[s], SORT_UNKNOWN_COMMIT) == 0)
+        {
+            printf("Error: commit %s matches every build without SORT_GIT_COMMIT; select those runs by id.\n",
+                   SORT_UNKNOWN_COMMIT);
+            free(resolved);
+            free(rows);
+            return -1;
+        }
+        const ResultRow *first = NULL;
+        int matched = 0;
+        for (int r = 0; r < numRows; r++)
+            if (resultMatches(&rows[r], resolved[s]))
+            {
+                first = first ? first : &rows[r];
+                matched++;
+            }
+        if (first == NULL)
+        {
+            printf("Error: no run or commit %s in %s.\n", resolved[s], store);
+            free(resolved);
+            free(rows);
+            return -1;
+        }
+        printf("%s: %d results, host %s, commit %s, seed %llu, %s\n    compiler %s, flags %s\n", resolved[s],
+               matched, first->host, first->commit, first->seed, first->time, first->compiler, first->flags);
+    }
+
+    int numSeries = 0, capacity = 16, multipleBenchmarks = 0;
+    ReportSeries *series = (ReportSeries *)calloc(capacity, sizeof(ReportSeries));
+    for (int r = 0; r < numRows; r++)
+    {
+        if (algorithm && strcmp(rows[r].algorithm, algorithm) != 0)
+            continue;
+        for (int s = 0; s < numSelectors; s++)
+        {
+            if (!resultMatches(&rows[r], resolved[s]))
+                continue;
+            int k = 0;
+            while (k < numSeries && !(series[k].selector == s && strcmp(series[k].benchmark, rows[r].benchmark) == 0 &&
+                                      strcmp(series[k].algorithm, rows[r].algorithm) == 0))
+                k++;
+            if (k == numSeries)
+            {
+                if (numSeries == capacity)
+                {
+                    series = (ReportSeries *)realloc(series, capacity * 2 * sizeof(ReportSeries));
+                    memset(series + capacity, 0, capacity * sizeof(ReportSeries));
+                    capacity *= 2;
+                }
+                series[k].selector = s;
+                series[k].benchmark = rows[r].benchmark;
+                series[k].algorithm = rows[r].algorithm;
+                multipleBenchmarks |= strcmp(series[k].benchmark, series[0].benchmark) != 0;
+                numSeries++;
+            }
+            addSeriesPoint(&series[k], &rows[r]);
+        }
+    }
+    if (numSeries == 0)
+    {
+        printf("Error: the selected runs hold no results%s%s.\n", algorithm ? " for " : "", algorithm ? algorithm : "");
+        free(series);
+        free(resolved);
+        free(rows);
+        return -1;
+    }
+
+    size_t length = strlen(prefix) + 16;
+    char *dataName = (char *)malloc(length), *diffName = (char *)malloc(length), *scriptName = (char *)malloc(length);
+    snprintf(dataName, length, "%s.dat", prefix);
+    snprintf(diffName, length, "%s_diff.dat", prefix);
+    snprintf(scriptName, length, "%s.gp", prefix);
+    FILE *data = fopen(dataName, "w");
+    FILE *script = fopen(scriptName, "w");
+    FILE *diff = numSelectors == 2 ? fopen(diffName, "w") : NULL;
+    int regressions = -1;
+    if (data == NULL || script == NULL || (numSelectors == 2 && diff == NULL))
+        printf("Error: cannot write the report files %s.*\n", prefix);
+    else
+    {
+        // One data block per series, selected with "index k"
+        for (int k = 0; k < numSeries; k++)
+        {
+            fprintf(data, "%s# %s %s %s\n# n seconds ci_low ci_high\n", k ? "\n\n" : "", resolved[series[k].selector],
+                    series[k].benchmark, series[k].algorithm);
+            for (int i = 0; i < series[k].count; i++)
+            {
+                const ResultRow *p = &series[k].points[i];
+                fprintf(data, "%d %.9g %.9g %.9g\n", p->n, p->seconds, p->ciLow, p->ciHigh);
+            }
+        }
+        fprintf(script, "set terminal svg size 1200,800 dynamic\n");
+        fprintf(script, "set output '%s.svg'\n", prefix);
+        fprintf(script, "set title 'Sorting Algorithm Performance'\n");
+        fprintf(script, "set xlabel 'Array Size'\nset ylabel 'Time (seconds)'\n");
+        fprintf(script, "set key outside\nset grid\nset logscale xy 10\n");
+        fprintf(script, "plot \\\n");
+        for (int k = 0; k < numSeries; k++)
+        {
+            fprintf(script, "    '%s' index %d using 1:2:3:4 with yerrorlines linewidth 2 %s title ", dataName, k,
+                    series[k].selector ? "dashtype 2" : "dashtype 1");
+            writePlotTitle(script, &series[k], resolved, numSelectors > 1, multipleBenchmarks);
+            fprintf(script, "%s\n", k + 1 < numSeries ? ", \\" : "");
+        }
+
+        regressions = diff ? writeReportDiff(diff, diffName, script, prefix, series, numSeries, resolved,
+                                             multipleBenchmarks)
+                           : 0;
+        printf("Report written to %s and %s; render with: gnuplot %s\n", dataName, scriptName, scriptName);
+    }
+    if (data)
+        fclose(data);
+    if (script)
+        fclose(script);
+    if (diff)
+        fclose(diff);
+    for (int k = 0; k < numSeries; k++)
+        free(series[k].points);
+    free(dataName);
+    free(diffName);
+    free(scriptName);
+    free(series);
+    free(resolved);
+    free(rows);
+    return regressions;
+}
+
+
+void printUsage(const char *program)
+{
+    printf("Usage: %s                      interactive benchmark and menu\n", program);
+    printf("       %s --bench-radix [maxN] radix sort benchmark\n", program);
+    printf("       %s --bench-parallel-radix [n] [threads] parallel radix scaling\n", program);
+    printf("       %s --bench-simd         SIMD sorting networks vs insertion sort\n", program);
+    printf("       %s --bench-pdq [maxN]   pdqsort vs quickSort and introSort with counters\n", program);
+    printf("       %s --bench-generic [n]  generic sorts per element type vs qsort\n", program);
+    printf("       %s --bench-float [maxN] float sorts on normal doubles, SIMD prescan, NaN and -0.0 order\n", program);
+    printf("       %s --external-sort input output [memoryMB] [tmpDir]\n", program);
+    printf("                              sort a binary int file larger than memory\n");
+    printf("       %s --bench-external [maxFileMB] [tmpDir]\n", program);
+    printf("       %s --distributed-sort input outputPrefix [workers]\n", program);
+    printf("                              sort a binary int file into per-range files with worker processes\n");
+    printf("       %s --bench-distributed [n] [maxWorkers] [tmpDir]\n", program);
+    printf("       %s --stream-sort [int|uint64] [input|-] [memoryMB] [tmpDir]\n", program);
+    printf("                              sort binary records from a file or stdin to stdout\n");
+    printf("       %s --tune               calibrate adaptive sort thresholds into %s\n", program, AUTO_CONFIG_FILE);
+    printf("       %s --bench-auto [maxN]  adaptive sort vs every fixed choice\n", program);
+    printf("       %s --bench-counting [maxN] counting sort on the narrow-range data sets\n", program);
+    printf("       %s --bench-shell [maxN] shell sort gap sequences across distributions\n", program);
+    printf("       %s --bench-heap [maxN]  bottom-up d-ary heap sort vs heapSort\n", program);
+    printf("       %s --bench-select [n] [threads] top-k, nth element and partial sort vs full sort\n", program);
+    printf("       %s --bench-payload [n]  argsort and key/payload sorts vs key-only sorts\n", program);
+    printf("       %s --bench-stable [n]   stability check, then time and memory of stable vs unstable sorts\n", program);
+    printf("       %s --bench-inplace [maxN] in-place merge sort vs buffered merge and heap sort\n", program);
+    printf("       %s --bench-multiway [maxN] multiway merge sort vs binary merge sorts with cache/TLB counters\n", program);
+    printf("       %s --bench-incremental [n] [batch] sorted container vs re-sorting after every batch\n", program);
+    printf("       %s --bench-counters [maxN] hardware counters, comparisons and swaps per algorithm\n", program);
+    printf("       %s --bench-samplesort [n] [threads] parallel samplesort vs parallel merge/radix and serial sorts\n", program);
+    printf("       %s --bench-strings [n] [file] string sorts vs qsort/strcmp on paths, IDs and a line file\n", program);
+    printf("       %s --verify [iterations] [seed] fuzz every algorithm for sortedness and permutation\n", program);
+    printf("       %s --regress [tolerance%%] [baseline] compare timings with the baseline of this host\n", program);
+    printf("       %s --regress-record [baseline] record the timing baseline (default %s)\n", program,
+           REGRESS_BASELINE_FILE);
+    printf("       %s --bench-stats [maxN] [interleaved|sequential] [core|-1] [seed]\n", program);
+    printf("                              every algorithm with confidence intervals and outliers, pinned to a core\n");
+    printf("       %s --report [store] [runA] [runB] gnuplot charts of stored runs, runB against runA\n", program);
+    printf("                              (runs by id, commit or latest; default %s, latest run)\n",
+           RESULTS_STORE_FILE);
+}
+
+int runCommand(int argc, char *argv[])
+{
+    srand(time(NULL));
+    rngState ^= (uint64_t)time(NULL);
+
+    if (strcmp(argv[1], "--bench-radix") == 0)
+    {
+        benchmarkRadix(argc > 2 ? atoi(argv[2]) : 10000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-counters") == 0)
+    {
+        benchmarkCounters(argc > 2 ? atoi(argv[2]) : 1000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-strings") == 0)
+    {
+        benchmarkStrings(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? argv[3] : NULL);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-samplesort") == 0)
+    {
+        benchmarkSampleSort(argc > 2 ? atoi(argv[2]) : 10000000, argc > 3 ? atoi(argv[3]) : hardwareThreads());
+        return 0;
+    }
+    if (strcmp(argv[1], "--verify") == 0)
+    {
+        uint64_t seed = argc > 3 ? strtoull(argv[3], NULL, 10) : rngState;
+        return runVerification(argc > 2 ? atoi(argv[2]) : 200, seed) == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[1], "--regress") == 0)
+    {
+        double tolerance = argc > 2 ? atof(argv[2]) : REGRESS_TOLERANCE;
+        return runRegression(argc > 3 ? argv[3] : REGRESS_BASELINE_FILE, tolerance, 0) == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[1], "--regress-record") == 0)
+        return runRegression(argc > 2 ? argv[2] : REGRESS_BASELINE_FILE, 0.0, 1) < 0 ? 1 : 0;
+    if (strcmp(argv[1], "--bench-stats") == 0)
+    {
+        if (argc > 4)
+            benchCore = atoi(argv[4]);
+        uint64_t seed = argc > 5 ? strtoull(argv[5], NULL, 10) : 12345;
+        int status = benchmarkStatistics(argc > 2 ? atoi(argv[2]) : 1024000,
+                                         !(argc > 3 && strcmp(argv[3], "sequential") == 0), seed);
+        return status == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[1], "--report") == 0)
+    {
+        const char **selectors = (const char **)(argv + 3);
+        int regressions = writeReport(argc > 2 ? argv[2] : RESULTS_STORE_FILE, selectors, argc > 3 ? argc - 3 : 0,
+                                      NULL, "sort_report");
+        return regressions == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[1], "--bench-incremental") == 0)
+    {
+        benchmarkIncremental(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? atoi(argv[3]) : 4096);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-multiway") == 0)
+    {
+        benchmarkMultiway(argc > 2 ? atoi(argv[2]) : 100000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-inplace") == 0)
+    {
+        benchmarkInPlace(argc > 2 ? atoi(argv[2]) : 10000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-stable") == 0)
+    {
+        benchmarkStability(argc > 2 ? atoi(argv[2]) : 1000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-payload") == 0)
+    {
+        benchmarkPayload(argc > 2 ? atoi(argv[2]) : 1000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-select") == 0)
+    {
+        benchmarkSelect(argc > 2 ? atoi(argv[2]) : 10000000, argc > 3 ? atoi(argv[3]) : hardwareThreads());
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-heap") == 0)
+    {
+        benchmarkHeap(argc > 2 ? atoi(argv[2]) : 10000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-shell") == 0)
+    {
+        benchmarkShell(argc > 2 ? atoi(argv[2]) : 1000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-counting") == 0)
+    {
+        benchmarkCounting(argc > 2 ? atoi(argv[2]) : 16384000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--tune") == 0)
+    {
+        tuneAutoSort(AUTO_CONFIG_FILE);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-auto") == 0)
+    {
+        return benchmarkAuto(argc > 2 ? atoi(argv[2]) : 1000000) == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[1], "--external-sort") == 0 && argc >= 4)
+    {
+        size_t memoryMB = argc > 4 ? (size_t)atol(argv[4]) : 256;
+        double start = wallTime();
+        int runs = externalSort(argv[2], argv[3], memoryMB << 20, argc > 5 ? argv[5] : ".");
+        if (runs < 0)
+            return 1;
+        printf("Sorted %s into %s using %d runs in %.3f seconds.\n", argv[2], argv[3], runs, wallTime() - start);
+        return 0;
+    }
+    if (strcmp(argv[1], "--stream-sort") == 0)
+    {
+        int type = argc > 2 && strcmp(argv[2], "uint64") == 0 ? STREAM_UINT64 : STREAM_INT32;
+        if (argc > 2 && strcmp(argv[2], "int") != 0 && strcmp(argv[2], "uint64") != 0)
+        {
+            fprintf(stderr, "Error: record type must be int or uint64.\n");
+            return 1;
+        }
+        size_t memoryMB = argc > 4 ? (size_t)atol(argv[4]) : 256;
+        StreamReport report;
+        if (streamSort(argc > 3 ? argv[3] : "-", 1, type, memoryMB << 20, argc > 5 ? argv[5] : ".", &report) != 0)
+            return 1;
+        printStreamReport(&report, type);
+        return 0;
+    }
+    if (strcmp(argv[1], "--distributed-sort") == 0 && argc >= 4)
+    {
+        int workers = argc > 4 ? atoi(argv[4]) : hardwareThreads();
+        WorkerReport *reports = (WorkerReport *)calloc(workers > 0 ? workers : 1, sizeof(WorkerReport));
+        double start = wallTime();
+        int status = distributedSort(argv[2], argv[3], workers, reports);
+        if (status == 0)
+            printDistributedReport(reports, workers, wallTime() - start);
+        free(reports);
+        return status == 0 ? 0 : 1;
+    }
+    if (strcmp(argv[1], "--bench-distributed") == 0)
+    {
+        benchmarkDistributed(argc > 2 ? atoi(argv[2]) : 1 << 24, argc > 3 ? atoi(argv[3]) : hardwareThreads(),
+                             argc > 4 ? argv[4] : ".");
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-external") == 0)
+    {
+        benchmarkExternal(argc > 2 ? atoi(argv[2]) : 256, argc > 3 ? argv[3] : ".");
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-generic") == 0)
+    {
+        benchmarkGeneric(argc > 2 ? atoi(argv[2]) : 1000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-float") == 0)
+    {
+        benchmarkFloat(argc > 2 ? atoi(argv[2]) : 4000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-pdq") == 0)
+    {
+        benchmarkPDQ(argc > 2 ? atoi(argv[2]) : 10000000);
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-simd") == 0)
+    {
+        benchmarkSIMD();
+        return 0;
+    }
+    if (strcmp(argv[1], "--bench-parallel-radix") == 0)
+    {
+        benchmarkParallelRadix(argc > 2 ? atoi(argv[2]) : 10000000, argc > 3 ? atoi(argv[3]) : hardwareThreads());
+        return 0;
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+        return runCommand(argc, argv);
+
+    int sizes[] = {1000, 2000, 4000, 8000, 16000, 32000, 64000};
+    int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+    int maxSize = 64000;
+
+    const char *algorithmNames[] = {"Bubble Sort", "Selection Sort", "Insertion Sort", "Merge Sort",
+                                    "Quick Sort",  "Heap Sort",      "Radix Sort",     "Shell Sort"};
+
+    FILE *fp = fopen("all_sorting_times.dat", "w");
+    if (fp == NULL)
+    {
+        printf("Error opening all_sorting_times.dat.\n");
+        return 1;
+    }
+    fprintf(fp, "# n bubble selection insertion merge quick heap radix shell\n");
+
+    int *arr = (int *)malloc(maxSize * sizeof(int));
+    int *temp = (int *)malloc(maxSize * sizeof(int));
+
+    unsigned seed = (unsigned)time(NULL);
+    srand(seed);
+    rngState ^= seed;
+    ResultsRun results;
+    resultsOpen(&results, RESULTS_STORE_FILE, seed);
+
+    for (int i = 0; i < maxSize; i++)
+        arr[i] = rand() % 1000;
+
+    // Every size is measured with the statistics harness: calibrated repetitions, algorithms
+    // interleaved in random order, each call on a fresh copy of the same input
+    void (*sorts[])(int[], int) = {bubbleSort, selectionSort, insertionSort, mergeSortRange,
+                                   quickSortRange, heapSort, radixSort, shellSort};
+    TimingStats stats[8];
+    printTimingHeader();
+    for (int i = 0; i < numSizes; i++)
+    {
+        int n = sizes[i];
+        measureSorts(sorts, NULL, 8, arr, temp, n, 1, stats);
+
+        fprintf(fp, "%d", n);
+        for (int a = 0; a < 8; a++)
+        {
+            printTimingStats(algorithmNames[a], n, &stats[a]);
+            fprintf(fp, " %f", stats[a].mean);
+            resultsAppend(&results, "main", algorithmNames[a], n, &stats[a]);
+        }
+        fprintf(fp, "\n");
+    }
+
+    fclose(fp);
+    resultsClose(&results);
+    free(arr);
+    free(temp);
+
+    int choice;
+    do
+    {
+        printf("\nSorting Algorithm Menu:\n");
+        printf("1. Bubble Sort\n");
+        printf("2. Selection Sort\n");
+        printf("3. Insertion Sort\n");
+        printf("4. Merge Sort\n");
+        printf("5. Quick Sort\n");
+        printf("6. Heap Sort\n");
+        printf("7. Radix Sort\n");
+        printf("8. Shell Sort\n");
+        printf("9. Auto (pick an algorithm from the input)\n");
+        printf("10. Write Comparison Report for All Algorithms\n");
+        printf("11. Write Single Algorithm Report\n");
+        printf("12. Exit\n");
+        printf("Enter your choice: ");
+        scanf("%d", &choice);
+
+        if (choice >= 1 && choice <= 9)
+        {
+            printf("Enter array size: ");
+            int n;
+            scanf("%d", &n);
+            int *testArr = (int *)malloc(n * sizeof(int));
+            for (int i = 0; i < n; i++)
+                testArr[i] = rand() % 1000;
+
+            clock_t start, end;
+            double timeTaken;
+
+            switch (choice)
+            {
+            case 1:
+                start = clock();
+                bubbleSort(testArr, n);
+                end = clock();
+                printf("Bubble Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
+                break;
+            case 2:
+                start = clock();
+                selectionSort(testArr, n);
+                end = clock();
+                printf("Selection Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
+                break;
+            case 3:
+                start = clock();
+                insertionSort(testArr, n);
+                end = clock();
+                printf("Insertion Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
+                break;
+            case 4:
+                start = clock();
+                mergeSort(testArr, 0, n - 1);
+                end = clock();
+                    printf("Merge Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
+                    break;
+                case 5:
+                    start = clock();
+                    quickSort(testArr, 0, n - 1);
+                    end = clock();
+                    printf("Quick Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
+                    break;
+                case 6:
+                    start = clock();
+                    heapSort(testArr, n);
+                    end = clock();
+                    printf("Heap Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
+                    break;
+                case 7:
+                    start = clock();
+                    radixSort(testArr, n);
+                    end = clock();
+                    printf("Radix Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
+                    break;
+                case 8:
+                    start = clock();
+                    shellSort(testArr, n);
+                    end = clock();
+                    printf("Shell Sort took %f seconds.\n", (double)(end - start) / CLOCKS_PER_SEC);
+                    break;
+                case 9:
+                    start = clock();
+                    int picked = autoSortChoice(testArr, n);
+                    end = clock();
+                    printf("Auto picked %s and took %f seconds.\n", autoChoiceNames[picked], (double)(end - start) / CLOCKS_PER_SEC);
+                    break;
+            }
+            free(testArr);
+        }
+        else if (choice == 10)
+        {
+            const char *run[] = {results.run};
+            writeReport(RESULTS_STORE_FILE, run, 1, NULL, "sort_report");
+            break;
+        }
+        else if (choice == 11)
         {
             printf("Enter the algorithm number (1: Bubble, 2: Selection, ... , 8: Shell): ");
             int algo;
             scanf("%d", &algo);
-            const char *algorithmNames[] = {
-                "Bubble Sort", "Selection Sort", "Insertion Sort", "Merge Sort",
-                "Quick Sort", "Heap Sort", "Radix Sort", "Shell Sort"};
             if (algo >= 1 && algo <= 8)
             {
-                executeGnuplotSingleAlgorithm(algorithmNames[algo - 1], algo + 1);
-                printf("Gnuplot executed for %s.\n", algorithmNames[algo - 1]);
+                const char *run[] = {results.run};
+                writeReport(RESULTS_STORE_FILE, run, 1, algorithmNames[algo - 1], "sort_report");
                 break;
             }
             else
@@ -459,12 +10226,12 @@ int main()
                 break;
             }
         }
-        else if (choice != 11)
+        else if (choice != 12)
         {
             printf("Invalid choice. Please try again.\n");
             break;
         }
-    } while (choice != 11);
+    } while (choice != 12);
 
     printf("Exiting program. Goodbye!\n");
     return 0;
@@ -220,6 +220,12 @@ int main() {
     int maxSize = 64000; // Maximum array size
 
     FILE *fp = fopen("normal_dist_sorting_times.dat", "w"); // File to save data for gnuplot
+    if (fp == NULL) {
+        printf("Error opening normal_dist_sorting_times.dat.\n");
+        return 1;
+    }
+    // Quick sort is left out, so the columns differ from all_sorting_times.dat
+    fprintf(fp, "# n bubble selection insertion merge heap radix shell\n");
 
     // Allocate memory for original and temporary arrays
     double mean = 50.0, stddev = 10.0;
@@ -293,7 +299,7 @@ int main() {
         double shellTime = (double)(end - start) / CLOCKS_PER_SEC;
 
         // Save times for gnuplot
-        fprintf(fp, "%d %f %f %f %f %f %f %f %f\n", n, bubbleTime, selectionTime, insertionTime, mergeTime, heapTime, radixTime, shellTime);
+        fprintf(fp, "%d %f %f %f %f %f %f %f\n", n, bubbleTime, selectionTime, insertionTime, mergeTime, heapTime, radixTime, shellTime);
     }
 
     fclose(fp);